@@ -0,0 +1,144 @@
+#pragma once
+
+#include <service/hsm.h>
+#include <service/channel.h>
+#include <service/work.h>
+#include <util/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Active object, a hierarchical state machine with its own event queue.
+ *
+ * Events are posted to the queue and dispatched one at a time by the work item of the object, so each event
+ * is processed to completion before the next one and state handlers never run concurrently. All storage is
+ * defined statically by `ACTIVE_OBJECT_DEFINE()`.
+ */
+struct active_object {
+    struct work work; ///< Work item dispatching the events.
+    struct channel *queue; ///< Event queue.
+    struct hsm hsm; ///< State machine.
+};
+
+/**
+ * Timer posting an event to an active object once it expires.
+ */
+struct active_object_timer {
+    struct work work; ///< Work item scheduled by the timer.
+    struct active_object *object; ///< Object the event is posted to.
+    struct hsm_event event; ///< Event to post.
+};
+
+/**
+ * Defines a new active object.
+ *
+ * The macro expands to multiple definitions and therefore cannot be prefixed with `static`.
+ *
+ * @param _name Name of the defined active object.
+ * @param _priority Priority of the work item (lower value means higher priority).
+ * @param _states Array of all states.
+ * @param _initial State entered by `active_object_start()`.
+ * @param _queue_size Maximum number of queued events, must be a power of two.
+ */
+#define ACTIVE_OBJECT_DEFINE(_name, _priority, _states, _initial, _queue_size) \
+    extern struct active_object _name; \
+    CHANNEL_DEFINE(_name##_queue, CHANNEL_MPSC, struct hsm_event, _queue_size, &_name.work); \
+    static uint8_t _name##_lca[(sizeof(_states) / sizeof((_states)[0])) * (sizeof(_states) / sizeof((_states)[0]))]; \
+    struct active_object _name = { \
+        WORK_INITIALIZER(_priority, active_object_work_handler), \
+        &_name##_queue, \
+        HSM_INITIALIZER(_states, _name##_lca, _initial), \
+    }
+
+/**
+ * Initializer for an active object timer.
+ *
+ * @param _priority Priority of the work item (lower value means higher priority).
+ * @param _object Active object the event is posted to.
+ * @param _signal Signal of the posted event.
+ * @param _param Parameter of the posted event.
+ */
+#define ACTIVE_OBJECT_TIMER_INITIALIZER(_priority, _object, _signal, _param) \
+    { WORK_INITIALIZER(_priority, active_object_timer_handler), _object, { _signal, _param } }
+
+/**
+ * Defines a new active object timer.
+ *
+ * @param _name Name of the defined timer.
+ * @param _priority Priority of the work item (lower value means higher priority).
+ * @param _object Active object the event is posted to.
+ * @param _signal Signal of the posted event.
+ * @param _param Parameter of the posted event.
+ */
+#define ACTIVE_OBJECT_TIMER_DEFINE(_name, _priority, _object, _signal, _param) \
+    struct active_object_timer _name = ACTIVE_OBJECT_TIMER_INITIALIZER(_priority, _object, _signal, _param)
+
+/**
+ * Enters the initial state of an active object.
+ *
+ * Events may be posted before, they are dispatched once the object was started.
+ *
+ * @param object Active object.
+ */
+void active_object_start(struct active_object *object);
+
+/**
+ * Posts an event to an active object.
+ *
+ * This function is safe to be called from ISRs.
+ *
+ * @param object Active object.
+ * @param signal Signal of the event.
+ * @param param Parameter of the event.
+ * @return True on success, false if the event queue is full.
+ */
+bool_t active_object_post(struct active_object *object, uint32_t signal, uint32_t param);
+
+/**
+ * Gets the active object which owns a state machine, intended to be used in state handlers.
+ *
+ * @param hsm State machine of an active object.
+ * @return Active object.
+ */
+struct active_object *active_object_from_hsm(struct hsm *hsm);
+
+/**
+ * Starts or restarts a timer.
+ *
+ * This function is safe to be called from ISRs.
+ *
+ * @param timer Timer.
+ * @param delay Delay in milliseconds after which the event is posted.
+ */
+void active_object_timer_start(struct active_object_timer *timer, u32_ms_t delay);
+
+/**
+ * Stops a timer.
+ *
+ * An event which was already posted by the timer is not removed from the event queue.
+ *
+ * This function is safe to be called from ISRs.
+ *
+ * @param timer Timer.
+ */
+void active_object_timer_stop(struct active_object_timer *timer);
+
+/**
+ * Work handler of active objects, dispatches one event per invocation.
+ *
+ * @param work Work item of the active object.
+ */
+void active_object_work_handler(struct work *work);
+
+/**
+ * Work handler of active object timers.
+ *
+ * @param work Work item of the timer.
+ */
+void active_object_timer_handler(struct work *work);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <service/work.h>
+#include <util/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct bus_topic;
+
+/**
+ * Callback of a subscriber, called in the context of the publisher with interrupts locked.
+ *
+ * @param topic Topic which was published.
+ * @param message Published message, only valid during the callback.
+ */
+typedef void (*bus_callback_t)(const struct bus_topic *topic, const void *message);
+
+/**
+ * Subscriber of a topic.
+ *
+ * Either a work item which is submitted if the topic is published or a callback which is called directly.
+ */
+struct bus_subscriber {
+    struct work *work; ///< Work item to submit, may be NULL.
+    bus_callback_t callback; ///< Callback to call, may be NULL.
+    struct bus_subscriber *next; ///< Next subscriber of the same topic.
+};
+
+/**
+ * Statistics of a topic.
+ */
+struct bus_topic_stats {
+    uint32_t publish_count; ///< Number of publishes.
+    u64_us_t since; ///< Uptime at which the statistics were reset.
+    u32_us_t latency_max; ///< Maximum time between publishing and reading of a message in microseconds.
+    u64_us_t latency_sum; ///< Sum of all latencies in microseconds.
+    uint32_t latency_count; ///< Number of recorded latencies.
+};
+
+/**
+ * Topic storing the last published message.
+ */
+struct bus_topic {
+    const char *name; ///< Name of the topic.
+    void *message; ///< Storage of the last published message.
+    size_t message_size; ///< Size of a message in bytes.
+    uint32_t sequence; ///< Incremented on every publish, zero if never published.
+    u64_us_t published; ///< Uptime at which the last message was published.
+    struct bus_subscriber *subscribers; ///< List of subscribers.
+    struct bus_topic_stats stats; ///< Statistics.
+};
+
+/**
+ * Defines a new topic.
+ *
+ * The macro expands to multiple definitions and therefore cannot be prefixed with `static`.
+ *
+ * @param _name Name of the defined topic.
+ * @param _type Type of the messages.
+ */
+#define BUS_TOPIC_DEFINE(_name, _type) \
+    typedef _type _name##_message_t; \
+    static _type _name##_message; \
+    struct bus_topic _name = { #_name, &_name##_message, sizeof(_type), 0, 0, NULL, { 0, 0, 0, 0, 0 } }
+
+/**
+ * Declares a topic defined in another file.
+ *
+ * @param _name Name of the topic.
+ * @param _type Type of the messages.
+ */
+#define BUS_TOPIC_DECLARE(_name, _type) \
+    typedef _type _name##_message_t; \
+    extern struct bus_topic _name
+
+/**
+ * Initializer for a subscriber submitting a work item.
+ *
+ * @param _work Work item to submit.
+ */
+#define BUS_SUBSCRIBER_WORK_INITIALIZER(_work) \
+    { _work, NULL, NULL }
+
+/**
+ * Initializer for a subscriber calling a callback.
+ *
+ * @param _callback Callback to call, see `bus_callback_t`.
+ */
+#define BUS_SUBSCRIBER_CALLBACK_INITIALIZER(_callback) \
+    { NULL, _callback, NULL }
+
+/**
+ * Publishes a message with type checking.
+ *
+ * @param _name Name of the topic.
+ * @param _message Pointer to the message.
+ */
+#define BUS_PUBLISH(_name, _message) \
+    do { \
+        const _name##_message_t *__message = (_message); \
+        bus_publish(&_name, __message); \
+    } while (0)
+
+/**
+ * Reads the last message with type checking.
+ *
+ * @param _name Name of the topic.
+ * @param _message Pointer to store the message.
+ * @return Sequence number of the message, see `bus_read()`.
+ */
+#define BUS_READ(_name, _message) \
+    __extension__ ({ \
+        _name##_message_t *__message = (_message); \
+        bus_read(&_name, __message); \
+    })
+
+/**
+ * Adds a subscriber to a topic.
+ *
+ * Subscribers are intended to be added during initialization.
+ *
+ * @param topic Topic to subscribe.
+ * @param subscriber Subscriber to add.
+ */
+void bus_subscribe(struct bus_topic *topic, struct bus_subscriber *subscriber);
+
+/**
+ * Stores a message and notifies all subscribers.
+ *
+ * The message is copied once into the storage of the topic. Work subscribers are submitted and read the
+ * message later, callbacks are called with a pointer to the stored message. If a topic is published again
+ * before a work subscriber read the message, the subscriber only sees the latest message.
+ *
+ * This function is safe to be called from ISRs if all callbacks are.
+ *
+ * @param topic Topic to publish.
+ * @param message Message, must have the message size of the topic.
+ */
+void bus_publish(struct bus_topic *topic, const void *message);
+
+/**
+ * Copies the last published message and records the latency since it was published.
+ *
+ * This function is safe to be called from ISRs.
+ *
+ * @param topic Topic to read.
+ * @param message Buffer for the message, must have the message size of the topic.
+ * @return Sequence number of the message which can be used to detect new messages, zero if the topic was
+ *         never published.
+ */
+uint32_t bus_read(struct bus_topic *topic, void *message);
+
+/**
+ * Gets the statistics of a topic and resets them.
+ *
+ * @param topic Topic.
+ * @param stats Statistics since the last reset.
+ */
+void bus_stats_read(struct bus_topic *topic, struct bus_topic_stats *stats);
+
+/**
+ * Calculates the publish rate from statistics.
+ *
+ * @param stats Statistics.
+ * @param now Current uptime in microseconds.
+ * @return Publishes per second.
+ */
+uint32_t bus_stats_publish_rate(const struct bus_topic_stats *stats, u64_us_t now);
+
+#ifdef __cplusplus
+}
+#endif
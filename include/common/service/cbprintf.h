@@ -37,6 +37,10 @@ void cbvprintf(cbprintf_out_t out, void *ctx, const char *format, va_list ap);
  * `packagted`. No formatting is done yet. The string can then be formatted later using `cbprintf_restore`.
  * For supported format string features see the `cbprintf` function.
  *
+ * The package consists of the format string pointer followed by the arguments, each stored with the size of
+ * its promoted type like in a variadic call (`char` and `short` take the size of an `int`). This is the same
+ * layout as `CBPRINTF_STATIC_PACKAGE` creates at compile time.
+ *
  * @warning The format string and any string arguments are not copied. Their memory must still be valid if
  *          the string is formatted using `cbprintf_restore`.
  *
@@ -64,6 +68,129 @@ size_t cbvprintf_capture(void *packaged, size_t length, const char *format, va_l
  */
 void cbprintf_restore(cbprintf_out_t out, void *ctx, const void *packaged, size_t length);
 
+/**
+ * Checks the arguments against the format string at compile time, never called.
+ *
+ * @param format Format string.
+ * @param ... Arguments for the format string.
+ */
+static inline void __attribute__((format(printf, 1, 2))) cbprintf_format_check(const char *format, ...)
+{
+    (void) format;
+}
+
+#ifndef __cplusplus
+
+/**
+ * Type an argument is stored with in a package.
+ *
+ * The conditional operator applies the same conversions as a variadic call: integers smaller than `int` are
+ * promoted and arrays decay to pointers.
+ */
+#define CBPRINTF_PACKAGE_ARG_TYPE(_arg) __typeof__(0 ? (_arg) : (_arg))
+
+/**
+ * Selects the macro declaring the argument fields by the number of arguments following the format string.
+ */
+#define CBPRINTF_PACKAGE_SELECT(_0, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _macro, ...) _macro
+
+#define CBPRINTF_PACKAGE_FIELDS(...) \
+    CBPRINTF_PACKAGE_SELECT(__VA_ARGS__, \
+        CBPRINTF_PACKAGE_FIELDS_10, CBPRINTF_PACKAGE_FIELDS_9, CBPRINTF_PACKAGE_FIELDS_8, \
+        CBPRINTF_PACKAGE_FIELDS_7, CBPRINTF_PACKAGE_FIELDS_6, CBPRINTF_PACKAGE_FIELDS_5, \
+        CBPRINTF_PACKAGE_FIELDS_4, CBPRINTF_PACKAGE_FIELDS_3, CBPRINTF_PACKAGE_FIELDS_2, \
+        CBPRINTF_PACKAGE_FIELDS_1, CBPRINTF_PACKAGE_FIELDS_0, ~)(__VA_ARGS__)
+
+#define CBPRINTF_PACKAGE_FIELD(_index, _arg) CBPRINTF_PACKAGE_ARG_TYPE(_arg) arg##_index;
+
+#define CBPRINTF_PACKAGE_FIELDS_0(_f)
+#define CBPRINTF_PACKAGE_FIELDS_1(_f, _a) \
+    CBPRINTF_PACKAGE_FIELD(1, _a)
+#define CBPRINTF_PACKAGE_FIELDS_2(_f, _a, _b) \
+    CBPRINTF_PACKAGE_FIELDS_1(_f, _a) CBPRINTF_PACKAGE_FIELD(2, _b)
+#define CBPRINTF_PACKAGE_FIELDS_3(_f, _a, _b, _c) \
+    CBPRINTF_PACKAGE_FIELDS_2(_f, _a, _b) CBPRINTF_PACKAGE_FIELD(3, _c)
+#define CBPRINTF_PACKAGE_FIELDS_4(_f, _a, _b, _c, _d) \
+    CBPRINTF_PACKAGE_FIELDS_3(_f, _a, _b, _c) CBPRINTF_PACKAGE_FIELD(4, _d)
+#define CBPRINTF_PACKAGE_FIELDS_5(_f, _a, _b, _c, _d, _e) \
+    CBPRINTF_PACKAGE_FIELDS_4(_f, _a, _b, _c, _d) CBPRINTF_PACKAGE_FIELD(5, _e)
+#define CBPRINTF_PACKAGE_FIELDS_6(_f, _a, _b, _c, _d, _e, _g) \
+    CBPRINTF_PACKAGE_FIELDS_5(_f, _a, _b, _c, _d, _e) CBPRINTF_PACKAGE_FIELD(6, _g)
+#define CBPRINTF_PACKAGE_FIELDS_7(_f, _a, _b, _c, _d, _e, _g, _h) \
+    CBPRINTF_PACKAGE_FIELDS_6(_f, _a, _b, _c, _d, _e, _g) CBPRINTF_PACKAGE_FIELD(7, _h)
+#define CBPRINTF_PACKAGE_FIELDS_8(_f, _a, _b, _c, _d, _e, _g, _h, _i) \
+    CBPRINTF_PACKAGE_FIELDS_7(_f, _a, _b, _c, _d, _e, _g, _h) CBPRINTF_PACKAGE_FIELD(8, _i)
+#define CBPRINTF_PACKAGE_FIELDS_9(_f, _a, _b, _c, _d, _e, _g, _h, _i, _j) \
+    CBPRINTF_PACKAGE_FIELDS_8(_f, _a, _b, _c, _d, _e, _g, _h, _i) CBPRINTF_PACKAGE_FIELD(9, _j)
+#define CBPRINTF_PACKAGE_FIELDS_10(_f, _a, _b, _c, _d, _e, _g, _h, _i, _j, _k) \
+    CBPRINTF_PACKAGE_FIELDS_9(_f, _a, _b, _c, _d, _e, _g, _h, _i, _j) CBPRINTF_PACKAGE_FIELD(10, _k)
+
+/**
+ * Defines a variable holding a package like `cbprintf_capture` creates it.
+ *
+ * The layout is computed by the compiler from the argument types, so the format string is not parsed and the
+ * arguments are stored without any runtime overhead. The package can be formatted using `cbprintf_restore`.
+ * Arguments must match the format string, which is checked by the compiler if combined with
+ * `cbprintf_format_check`. At most 10 arguments are supported.
+ *
+ * Usage: `CBPRINTF_STATIC_PACKAGE(package, "%d", 42); cbprintf_restore(out, ctx, &package, sizeof(package));`
+ *
+ * @param _name Name of the defined variable.
+ * @param ... Format string and arguments.
+ */
+#define CBPRINTF_STATIC_PACKAGE(_name, ...) \
+    struct __attribute__((packed)) { \
+        const char *format; \
+        CBPRINTF_PACKAGE_FIELDS(__VA_ARGS__) \
+    } _name = { __VA_ARGS__ }
+
+#else
+
+#define CBPRINTF_STATIC_PACKAGE(_name, ...) \
+    const auto _name = cbprintf_static_package(__VA_ARGS__)
+
+#endif
+
 #ifdef __cplusplus
 }
 #endif
+
+#ifdef __cplusplus
+
+#include <cstring>
+
+/**
+ * Package created at compile time, see `CBPRINTF_STATIC_PACKAGE`.
+ */
+template <size_t N>
+struct cbprintf_package {
+    uint8_t data[N]; ///< Format string pointer followed by the promoted arguments.
+};
+
+/**
+ * Creates a package like `cbprintf_capture` with the layout computed from the argument types.
+ *
+ * The unary plus applies the same promotions as a variadic call.
+ *
+ * @param format Format string.
+ * @param args Arguments for the format string.
+ * @return Package to be formatted using `cbprintf_restore`.
+ */
+template <typename... Args>
+inline auto cbprintf_static_package(const char *format, Args... args)
+{
+    cbprintf_package<sizeof(format) + (sizeof(+args) + ... + 0)> package;
+    size_t index = 0;
+
+    auto store = [&package, &index](auto value) {
+        std::memcpy(package.data + index, &value, sizeof(value));
+        index += sizeof(value);
+    };
+
+    store(format);
+    (store(+args), ...);
+
+    return package;
+}
+
+#endif
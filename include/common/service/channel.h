@@ -0,0 +1,126 @@
+#pragma once
+
+#include <service/work.h>
+#include <service/assert.h>
+#include <util/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Channel types.
+ */
+enum channel_type {
+    CHANNEL_SPSC = 0, ///< Single producer, single consumer.
+    CHANNEL_MPSC = 1, ///< Multiple producers (e.g. ISRs of different priorities), single consumer.
+};
+
+/**
+ * Lock-free ring buffer of fixed size elements.
+ *
+ * Producers reserve an element, fill it in place and commit it. The consumer peeks at the oldest committed
+ * element and releases it after processing. Elements are committed to the consumer in the order they were
+ * reserved.
+ *
+ * Single producer channels allow one outstanding reservation. Multi producer channels allow one outstanding
+ * reservation per producer, they use a sequence number per element to detect committed elements (Vyukov's
+ * bounded queue).
+ */
+struct channel {
+    uint8_t *buffer; ///< Storage for `capacity` elements.
+    uint32_t *sequence; ///< Sequence numbers relative to the element index (multi producer channels only).
+    uint32_t element_size; ///< Size of a single element in bytes.
+    uint32_t capacity; ///< Number of elements, power of two.
+    enum channel_type type; ///< Type of the channel.
+    struct work *consumer; ///< Work item submitted on every commit, may be NULL.
+    uint32_t head; ///< Position of the next element to consume.
+    uint32_t tail; ///< Position of the next element to reserve.
+    uint32_t high_watermark; ///< Maximum number of elements which were reserved or committed at the same time.
+    uint32_t overflows; ///< Number of failed reservations because the channel was full.
+};
+
+/**
+ * Defines a new channel with static storage.
+ *
+ * The macro expands to multiple definitions and therefore cannot be prefixed with `static`.
+ *
+ * @param _name Name of the defined channel.
+ * @param _type Type of the channel, see `enum channel_type`.
+ * @param _element_type Type of the elements.
+ * @param _capacity Number of elements, must be a power of two.
+ * @param _consumer Work item to submit if an element is committed, may be NULL.
+ */
+#define CHANNEL_DEFINE(_name, _type, _element_type, _capacity, _consumer) \
+    BUILD_ASSERT(((_capacity) > 0) && (((_capacity) & ((_capacity) - 1)) == 0)); \
+    static _element_type _name##_buffer[_capacity]; \
+    static uint32_t _name##_sequence[((_type) == CHANNEL_MPSC) ? (_capacity) : 1]; \
+    struct channel _name = { \
+        (uint8_t *) _name##_buffer, _name##_sequence, sizeof(_element_type), _capacity, _type, _consumer, \
+        0, 0, 0, 0, \
+    }
+
+/**
+ * Reserves the next element.
+ *
+ * This function is safe to be called from ISRs.
+ *
+ * @param channel Channel.
+ * @return Element to fill or NULL if the channel is full.
+ */
+void *channel_reserve(struct channel *channel);
+
+/**
+ * Commits a reserved element and submits the consumer work item.
+ *
+ * This function is safe to be called from ISRs.
+ *
+ * @param channel Channel.
+ * @param element Element returned by `channel_reserve()`.
+ */
+void channel_commit(struct channel *channel, void *element);
+
+/**
+ * Copies an element into the channel.
+ *
+ * This function is safe to be called from ISRs.
+ *
+ * @param channel Channel.
+ * @param element Element to copy, must have the element size of the channel.
+ * @return True on success, false if the channel is full.
+ */
+bool_t channel_send(struct channel *channel, const void *element);
+
+/**
+ * Returns the oldest committed element without removing it.
+ *
+ * May only be called by the consumer.
+ *
+ * @param channel Channel.
+ * @return Element or NULL if there is no committed element.
+ */
+void *channel_peek(struct channel *channel);
+
+/**
+ * Removes the element returned by `channel_peek()`.
+ *
+ * May only be called by the consumer.
+ *
+ * @param channel Channel.
+ */
+void channel_release(struct channel *channel);
+
+/**
+ * Copies the oldest committed element out of the channel and removes it.
+ *
+ * May only be called by the consumer.
+ *
+ * @param channel Channel.
+ * @param element Buffer for the element, must have the element size of the channel.
+ * @return True on success, false if there was no committed element.
+ */
+bool_t channel_receive(struct channel *channel, void *element);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <service/work.h>
+#include <util/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Work item submitted once a completion is signaled.
+ */
+struct completion_continuation {
+    struct work work; ///< Work item to submit.
+    struct completion_continuation *next; ///< Next continuation of the same completion.
+    bool_t waiting; ///< True while the continuation is registered.
+};
+
+/**
+ * Completion which is signaled once an operation has finished.
+ *
+ * Continuations registered with `completion_then()` are submitted when the completion is signaled. They are
+ * one-shot, they have to be registered again to wait for the next completion after a reset.
+ */
+struct completion {
+    struct completion_continuation *continuations; ///< Registered continuations in order of registration.
+    uint32_t count; ///< Number of times the completion was signaled.
+    bool_t done; ///< True if signaled since the last reset.
+};
+
+/**
+ * Work item with a completion which is signaled every time the handler returns.
+ */
+struct completion_work {
+    struct work work; ///< Work item.
+    work_handler_t handler; ///< Handler called with `work`.
+    struct completion completion; ///< Completion signaled after the handler returned.
+};
+
+/**
+ * Initializer for a completion.
+ */
+#define COMPLETION_INITIALIZER() \
+    { NULL, 0, false }
+
+/**
+ * Initializer for a continuation.
+ *
+ * @param _priority Priority (lower value means higher priority).
+ * @param _handler Function to execute once the completion is signaled.
+ */
+#define COMPLETION_CONTINUATION_INITIALIZER(_priority, _handler) \
+    { WORK_INITIALIZER(_priority, _handler), NULL, false }
+
+/**
+ * Defines a new continuation.
+ *
+ * @param _name Name of the defined continuation.
+ * @param _priority Priority (lower value means higher priority).
+ * @param _handler Function to execute once the completion is signaled.
+ */
+#define COMPLETION_CONTINUATION_DEFINE(_name, _priority, _handler) \
+    struct completion_continuation _name = COMPLETION_CONTINUATION_INITIALIZER(_priority, _handler)
+
+/**
+ * Initializer for a work item with completion.
+ *
+ * @param _priority Priority (lower value means higher priority).
+ * @param _handler Function to execute the work, called with the embedded work item.
+ */
+#define COMPLETION_WORK_INITIALIZER(_priority, _handler) \
+    { WORK_INITIALIZER(_priority, completion_work_handler), _handler, COMPLETION_INITIALIZER() }
+
+/**
+ * Defines a new work item with completion.
+ *
+ * @param _name Name of the defined work item.
+ * @param _priority Priority (lower value means higher priority).
+ * @param _handler Function to execute the work, called with the embedded work item.
+ */
+#define COMPLETION_WORK_DEFINE(_name, _priority, _handler) \
+    struct completion_work _name = COMPLETION_WORK_INITIALIZER(_priority, _handler)
+
+/**
+ * Signals a completion and submits all registered continuations.
+ *
+ * This function is safe to be called from ISRs.
+ *
+ * @param completion Completion.
+ */
+void completion_complete(struct completion *completion);
+
+/**
+ * Resets a completion to not done.
+ *
+ * This function is safe to be called from ISRs.
+ *
+ * @param completion Completion.
+ */
+void completion_reset(struct completion *completion);
+
+/**
+ * Checks if a completion was signaled since the last reset.
+ *
+ * @param completion Completion.
+ * @return True if done.
+ */
+bool_t completion_is_done(const struct completion *completion);
+
+/**
+ * Registers a continuation which is submitted once the completion is signaled.
+ *
+ * If the completion is already done, the continuation is submitted immediately. If the continuation is
+ * already registered, this function does nothing.
+ *
+ * This function is safe to be called from ISRs.
+ *
+ * @param completion Completion.
+ * @param continuation Continuation.
+ */
+void completion_then(struct completion *completion, struct completion_continuation *continuation);
+
+/**
+ * Removes a registered continuation.
+ *
+ * If the continuation is not registered, this function does nothing. A continuation which was already
+ * submitted is not cancelled.
+ *
+ * This function is safe to be called from ISRs.
+ *
+ * @param completion Completion.
+ * @param continuation Continuation.
+ */
+void completion_cancel(struct completion *completion, struct completion_continuation *continuation);
+
+/**
+ * Resets the completion of a work item and submits it.
+ *
+ * This function is safe to be called from ISRs.
+ *
+ * @param work Work item with completion.
+ */
+void completion_work_submit(struct completion_work *work);
+
+/**
+ * Work handler of work items with completion, calls the handler and signals the completion.
+ *
+ * @param work Work item embedded in a `struct completion_work`.
+ */
+void completion_work_handler(struct work *work);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <service/work.h>
+#include <util/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Trailing edge debouncer.
+ *
+ * Submits the target work item once events stopped for the quiet period. Events occurring while a submission
+ * is pending restart the quiet period and are counted as suppressed.
+ */
+struct debounce {
+    struct work work; ///< Internal work item checking for the end of the quiet period.
+    struct work *target; ///< Work item to submit after the quiet period.
+    u32_ms_t quiet_period; ///< Time in milliseconds without events before the target is submitted.
+    u64_tick_t last_event; ///< Uptime of the last event in ticks.
+    bool_t pending; ///< True if the target will be submitted after the quiet period.
+    uint32_t suppressed; ///< Number of events which did not lead to their own submission.
+};
+
+/**
+ * Initializer for a debouncer.
+ *
+ * @param _target Work item to submit after the quiet period.
+ * @param _quiet_period Time in milliseconds without events before the target is submitted.
+ */
+#define DEBOUNCE_INITIALIZER(_target, _quiet_period) \
+    { WORK_INITIALIZER(0, debounce_work_handler), _target, _quiet_period, 0, false, 0 }
+
+/**
+ * Defines a new debouncer.
+ *
+ * @param _name Name of the defined debouncer.
+ * @param _target Work item to submit after the quiet period.
+ * @param _quiet_period Time in milliseconds without events before the target is submitted.
+ */
+#define DEBOUNCE_DEFINE(_name, _target, _quiet_period) \
+    struct debounce _name = DEBOUNCE_INITIALIZER(_target, _quiet_period)
+
+/**
+ * Records an event.
+ *
+ * If no submission is pending, the debouncer is scheduled after the quiet period. Otherwise, only the time of
+ * the event is recorded, the quiet period is extended lazily by the debouncer work item. This keeps the cost
+ * for bouncing inputs constant.
+ *
+ * This function is safe to be called from ISRs.
+ *
+ * @param debounce Debouncer.
+ */
+void debounce_trigger(struct debounce *debounce);
+
+/**
+ * Cancels a pending submission.
+ *
+ * This function is safe to be called from ISRs.
+ *
+ * @param debounce Debouncer.
+ */
+void debounce_cancel(struct debounce *debounce);
+
+/**
+ * Work handler of debouncers.
+ *
+ * This function is intended for internal use by `DEBOUNCE_INITIALIZER()`.
+ *
+ * @param work Internal work item of the debouncer.
+ */
+void debounce_work_handler(struct work *work);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <service/work.h>
+#include <util/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Options of an event waiter.
+ */
+enum event_waiter_options {
+    EVENT_WAIT_ANY = 0, ///< Wake up if any of the bits is set.
+    EVENT_WAIT_ALL = (1 << 0), ///< Wake up if all of the bits are set.
+    EVENT_WAIT_CLEAR = (1 << 1), ///< Clear the matched bits when waking up.
+};
+
+/**
+ * Work item waiting for bits of an event flags object.
+ */
+struct event_waiter {
+    struct work work; ///< Work item submitted when the condition matches.
+    struct event_waiter *next; ///< Next waiter of the same event flags object.
+    uint32_t mask; ///< Bits to wait for.
+    uint32_t matched; ///< Bits which were set when the condition matched.
+    uint8_t options; ///< Combination of `enum event_waiter_options`.
+    bool_t waiting; ///< True while the waiter is registered.
+};
+
+/**
+ * Set of 32 event flags.
+ */
+struct event_flags {
+    uint32_t flags; ///< Currently set bits.
+    struct event_waiter *waiters; ///< Registered waiters in order of registration.
+};
+
+/**
+ * Initializer for an event flags object.
+ */
+#define EVENT_FLAGS_INITIALIZER() \
+    { 0, NULL }
+
+/**
+ * Defines a new event flags object.
+ *
+ * @param _name Name of the defined object.
+ */
+#define EVENT_FLAGS_DEFINE(_name) \
+    struct event_flags _name = EVENT_FLAGS_INITIALIZER()
+
+/**
+ * Initializer for an event waiter.
+ *
+ * @param _priority Priority of the work item (lower value means higher priority).
+ * @param _handler Function to execute the work, see `event_waiter_matched()`.
+ * @param _mask Bits to wait for.
+ * @param _options Combination of `enum event_waiter_options`.
+ */
+#define EVENT_WAITER_INITIALIZER(_priority, _handler, _mask, _options) \
+    { WORK_INITIALIZER(_priority, _handler), NULL, _mask, 0, _options, false }
+
+/**
+ * Defines a new event waiter.
+ *
+ * @param _name Name of the defined waiter.
+ * @param _priority Priority of the work item (lower value means higher priority).
+ * @param _handler Function to execute the work, see `event_waiter_matched()`.
+ * @param _mask Bits to wait for.
+ * @param _options Combination of `enum event_waiter_options`.
+ */
+#define EVENT_WAITER_DEFINE(_name, _priority, _handler, _mask, _options) \
+    struct event_waiter _name = EVENT_WAITER_INITIALIZER(_priority, _handler, _mask, _options)
+
+/**
+ * Sets bits and submits all waiters whose condition matches.
+ *
+ * Waiters are checked in order of registration. If a waiter clears the matched bits, waiters registered
+ * later won't see them anymore.
+ *
+ * All waiters are handled within a single critical section. This function is safe to be called from ISRs.
+ *
+ * @param event_flags Event flags object.
+ * @param bits Bits to set.
+ */
+void event_flags_post(struct event_flags *event_flags, uint32_t bits);
+
+/**
+ * Clears bits.
+ *
+ * This function is safe to be called from ISRs.
+ *
+ * @param event_flags Event flags object.
+ * @param bits Bits to clear.
+ */
+void event_flags_clear(struct event_flags *event_flags, uint32_t bits);
+
+/**
+ * Returns the currently set bits.
+ *
+ * @param event_flags Event flags object.
+ * @return Currently set bits.
+ */
+uint32_t event_flags_get(struct event_flags *event_flags);
+
+/**
+ * Registers a waiter to be submitted once its condition matches.
+ *
+ * Waiters are one-shot, the handler has to call this function again to wait for further events. If the
+ * condition already matches, the waiter is submitted immediately. If the waiter is already registered,
+ * this function does nothing.
+ *
+ * This function is safe to be called from ISRs.
+ *
+ * @param event_flags Event flags object.
+ * @param waiter Waiter to register.
+ */
+void event_flags_wait(struct event_flags *event_flags, struct event_waiter *waiter);
+
+/**
+ * Removes a registered waiter.
+ *
+ * If the waiter was already submitted, it is not cancelled.
+ *
+ * This function is safe to be called from ISRs.
+ *
+ * @param event_flags Event flags object.
+ * @param waiter Waiter to remove.
+ */
+void event_flags_cancel(struct event_flags *event_flags, struct event_waiter *waiter);
+
+/**
+ * Returns the bits which matched when the waiter was woken up.
+ *
+ * Intended to be called by the handler of the waiter.
+ *
+ * @param work Work item of the waiter.
+ * @return Matched bits.
+ */
+uint32_t event_waiter_matched(struct work *work);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <util/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Maximum nesting depth of states.
+ */
+#define HSM_MAX_DEPTH     8
+
+/**
+ * Index used in the LCA table if two states have no common ancestor.
+ */
+#define HSM_STATE_NONE    UINT8_MAX
+
+struct hsm;
+
+/**
+ * Event dispatched to a state machine.
+ */
+struct hsm_event {
+    uint32_t signal; ///< Type of the event, defined by the application.
+    uint32_t param; ///< Parameter of the event.
+};
+
+/**
+ * Result of an event handler.
+ */
+enum hsm_result {
+    HSM_HANDLED, ///< Event was handled.
+    HSM_UNHANDLED, ///< Event was not handled and is passed to the parent state.
+    HSM_TRANSITION, ///< Event was handled and caused a transition, see `hsm_transition()`.
+};
+
+/**
+ * State of a hierarchical state machine.
+ *
+ * All states of a state machine must be elements of the same array.
+ */
+struct hsm_state {
+    const char *name; ///< Name of the state.
+    const struct hsm_state *parent; ///< Parent state or NULL for a top level state.
+    const struct hsm_state *initial; ///< Descendant entered after this state was entered, NULL for leaf states.
+    void (*entry)(struct hsm *hsm); ///< Called when the state is entered, may be NULL.
+    void (*exit)(struct hsm *hsm); ///< Called when the state is exited, may be NULL.
+    enum hsm_result (*handler)(struct hsm *hsm, const struct hsm_event *event); ///< Event handler, may be NULL.
+};
+
+/**
+ * Hierarchical state machine.
+ *
+ * Transitions exit all states from the current state up to the least common ancestor (LCA) of the handling
+ * state and the target and enter all states from there down to the target. The LCA of each pair of states is
+ * computed once by `hsm_init()`, so dispatching events does not search the state tree.
+ *
+ * Transitions to the handling state itself or to an ancestor exit and enter that state again. Transitions to
+ * a descendant of the handling state don't exit the handling state.
+ */
+struct hsm {
+    const struct hsm_state *states; ///< Array of all states.
+    uint8_t state_count; ///< Number of states.
+    uint8_t *lca; ///< LCA table with `state_count * state_count` entries, filled by `hsm_init()`.
+    const struct hsm_state *initial; ///< State entered by `hsm_init()`.
+    const struct hsm_state *current; ///< Current leaf state.
+    const struct hsm_state *target; ///< Target of the pending transition.
+};
+
+/**
+ * Initializer for a state machine.
+ *
+ * @param _states Array of all states.
+ * @param _lca Array of `_count * _count` bytes for the LCA table.
+ * @param _initial State entered by `hsm_init()`.
+ */
+#define HSM_INITIALIZER(_states, _lca, _initial) \
+    { _states, sizeof(_states) / sizeof((_states)[0]), _lca, _initial, NULL, NULL }
+
+/**
+ * Defines a new state machine.
+ *
+ * The macro expands to multiple definitions and therefore cannot be prefixed with `static`.
+ *
+ * @param _name Name of the defined state machine.
+ * @param _states Array of all states.
+ * @param _initial State entered by `hsm_init()`.
+ */
+#define HSM_DEFINE(_name, _states, _initial) \
+    static uint8_t _name##_lca[(sizeof(_states) / sizeof((_states)[0])) * (sizeof(_states) / sizeof((_states)[0]))]; \
+    struct hsm _name = HSM_INITIALIZER(_states, _name##_lca, _initial)
+
+/**
+ * Computes the LCA table and enters the initial state.
+ *
+ * @param hsm State machine.
+ */
+void hsm_init(struct hsm *hsm);
+
+/**
+ * Dispatches an event to the current state and its ancestors until it is handled.
+ *
+ * Transitions requested by the handler are executed before this function returns (run to completion).
+ *
+ * @param hsm State machine.
+ * @param event Event to dispatch.
+ */
+void hsm_dispatch(struct hsm *hsm, const struct hsm_event *event);
+
+/**
+ * Requests a transition, intended to be returned by an event handler.
+ *
+ * @param hsm State machine.
+ * @param target Target state.
+ * @return `HSM_TRANSITION`.
+ */
+enum hsm_result hsm_transition(struct hsm *hsm, const struct hsm_state *target);
+
+/**
+ * Checks if a state is the current state or one of its ancestors.
+ *
+ * @param hsm State machine.
+ * @param state State to check.
+ * @return True if the state is active.
+ */
+bool_t hsm_in_state(const struct hsm *hsm, const struct hsm_state *state);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,7 +1,17 @@
 #pragma once
 
+#include <service/cbprintf.h>
+#include <util/types.h>
+
 #define DEFAULT_LOG_LEVEL  LOG_LEVEL_INF
 
+#ifndef LOG_HEXDUMP_MAX_LENGTH
+#define LOG_HEXDUMP_MAX_LENGTH     64    ///< Maximum number of bytes stored by a hexdump, longer data is truncated.
+#endif
+
+#define LOG_RATELIMIT_BURST        5     ///< Default number of messages a call site may log at once.
+#define LOG_RATELIMIT_INTERVAL_MS  1000  ///< Default time in milliseconds to regain one message.
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -16,36 +26,129 @@ enum log_level {
     LOG_LEVEL_DBG = 3, ///< Debug message
 };
 
+/**
+ * Log lanes.
+ *
+ * Each lane has its own message buffer, so a flood of less important messages cannot take the space needed
+ * for errors. Messages of all lanes are output interleaved by their timestamp.
+ */
+enum log_lane {
+    LOG_LANE_HIGH = 0, ///< Errors and warnings
+    LOG_LANE_LOW = 1, ///< Information and debug messages
+    LOG_LANE_COUNT, ///< Number of lanes
+};
+
+/**
+ * Behavior of a log lane when its message buffer is full.
+ */
+enum log_policy {
+    LOG_POLICY_DROP_NEWEST = 0, ///< The new message is dropped.
+    LOG_POLICY_OVERWRITE_OLDEST = 1, ///< The oldest messages are freed to make space for the new message.
+};
+
 /**
  * Log module information.
  */
 struct log_module {
     const char *name; ///< Name of this module.
     enum log_level level; ///< Minimum log level of this module.
+    uint8_t index; ///< Index of this module in log messages, assigned on registration.
     struct log_module *next; ///< Next module to form a linked list of all registered modules.
 };
 
+/**
+ * Rate limit of a single call site.
+ *
+ * The limit is a token bucket implemented as virtual scheduling: instead of counting tokens, the time at which the
+ * bucket would be full again is stored. Checking the limit only requires additions and comparisons.
+ */
+struct log_ratelimit {
+    u64_tick_t full_at; ///< Uptime at which the bucket is full again.
+    uint32_t suppressed; ///< Number of messages suppressed since the last logged message.
+};
+
 /**
  * Registers a new log module.
  *
+ * The optional level is the most verbose level compiled into the module and its initial runtime level.
+ * Calls of more verbose macros are removed at compile time including their format strings. Without a level,
+ * all levels are compiled in and the initial runtime level is `DEFAULT_LOG_LEVEL`.
+ *
+ * Usage: `LOG_MODULE_REGISTER(name)` or `LOG_MODULE_REGISTER(name, LOG_LEVEL_WRN)`.
+ *
+ * @param _name Name of the module.
+ * @param _level Optional compile-time level of the module.
+ */
+#define LOG_MODULE_REGISTER(...) \
+    LOG_MODULE_SELECT(__VA_ARGS__, LOG_MODULE_REGISTER_LEVEL, LOG_MODULE_REGISTER_DEFAULT, ~)(__VA_ARGS__)
+
+/**
+ * Selects the registration macro by the number of arguments.
+ */
+#define LOG_MODULE_SELECT(_1, _2, _macro, ...) _macro
+
+/**
+ * Registers a new log module with all levels compiled in.
+ *
+ * @param _name Name of the module.
+ */
+#define LOG_MODULE_REGISTER_DEFAULT(_name) \
+    LOG_MODULE_DEFINE(_name, LOG_LEVEL_DBG, DEFAULT_LOG_LEVEL)
+
+/**
+ * Registers a new log module with a compile-time level.
+ *
  * @param _name Name of the module.
+ * @param _level Compile-time and initial runtime level.
  */
-#define LOG_MODULE_REGISTER(_name) \
+#define LOG_MODULE_REGISTER_LEVEL(_name, _level) \
+    LOG_MODULE_DEFINE(_name, _level, _level)
+
+/**
+ * Defines the log module of a file.
+ *
+ * @param _name Name of the module.
+ * @param _compiled_level Most verbose level compiled in.
+ * @param _level Initial runtime level.
+ */
+#define LOG_MODULE_DEFINE(_name, _compiled_level, _level) \
+    enum { __log_compiled_level = (int) (_compiled_level) }; \
     static struct log_module __log_module = { \
-        #_name, DEFAULT_LOG_LEVEL, NULL, \
+        #_name, _level, 0, NULL, \
     }; \
     static void __attribute__((constructor)) __log_module_register_this(void) { \
         log_module_register(&__log_module); \
     } \
     void log_module_register(struct log_module *)  // some declaration for semicolon after macro
 
+/**
+ * Logs a message if its level is enabled for the module.
+ *
+ * Disabled levels are removed at compile time, the runtime level of the module is checked before the
+ * arguments are evaluated. The arguments are packed with a layout computed at compile time, so the format
+ * string is only parsed when the message is output.
+ *
+ * @param _level Log level of the message.
+ * @param ... Format string and at most 10 arguments.
+ */
+#define LOG_MESSAGE(_level, ...) \
+    do { \
+        if (((int) (_level) <= __log_compiled_level) && ((_level) <= __log_module.level)) { \
+            if (0) { \
+                cbprintf_format_check(__VA_ARGS__); \
+            } \
+            CBPRINTF_STATIC_PACKAGE(__log_package, __VA_ARGS__); \
+            log_message_package(&__log_module, _level, &__log_package, sizeof(__log_package)); \
+        } \
+    } while (0)
+
 /**
  * Logs an error message.
  *
  * The macro takes printf style arguments. It is safe to use from ISRs.
  * The provided information is recorded and outputted later by the logging work item.
  */
-#define LOG_ERR(...) log_message(&__log_module, LOG_LEVEL_ERR, __VA_ARGS__)
+#define LOG_ERR(...) LOG_MESSAGE(LOG_LEVEL_ERR, __VA_ARGS__)
 
 /**
  * Logs a warning message.
@@ -53,7 +156,7 @@ struct log_module {
  * The macro takes printf style arguments. It is safe to use from ISRs.
  * The provided information is recorded and outputted later by the logging work item.
  */
-#define LOG_WRN(...) log_message(&__log_module, LOG_LEVEL_WRN, __VA_ARGS__)
+#define LOG_WRN(...) LOG_MESSAGE(LOG_LEVEL_WRN, __VA_ARGS__)
 
 /**
  * Logs an info message.
@@ -61,7 +164,7 @@ struct log_module {
  * The macro takes printf style arguments. It is safe to use from ISRs.
  * The provided information is recorded and outputted later by the logging work item.
  */
-#define LOG_INF(...) log_message(&__log_module, LOG_LEVEL_INF, __VA_ARGS__)
+#define LOG_INF(...) LOG_MESSAGE(LOG_LEVEL_INF, __VA_ARGS__)
 
 /**
  * Logs a debug message.
@@ -69,7 +172,96 @@ struct log_module {
  * The macro takes printf style arguments. It is safe to use from ISRs.
  * The provided information is recorded and outputted later by the logging work item.
  */
-#define LOG_DBG(...) log_message(&__log_module, LOG_LEVEL_DBG, __VA_ARGS__)
+#define LOG_DBG(...) LOG_MESSAGE(LOG_LEVEL_DBG, __VA_ARGS__)
+
+/**
+ * Logs binary data as hexdump if its level is enabled for the module.
+ *
+ * The data is copied once into the log buffer, up to `LOG_HEXDUMP_MAX_LENGTH` bytes, and formatted by the
+ * logging work item as lines with offset, hex values and ASCII characters. It is safe to use from ISRs.
+ *
+ * @param _level Log level of the hexdump.
+ * @param _data Data to dump.
+ * @param _length Length of the data in bytes.
+ * @param _description Description printed before the data, a string constant.
+ */
+#define LOG_HEXDUMP(_level, _data, _length, _description) \
+    do { \
+        if (((int) (_level) <= __log_compiled_level) && ((_level) <= __log_module.level)) { \
+            log_hexdump(&__log_module, _level, _data, _length, _description); \
+        } \
+    } while (0)
+
+/**
+ * Logs binary data as hexdump with error level, see `LOG_HEXDUMP()`.
+ */
+#define LOG_HEXDUMP_ERR(_data, _length, _description) LOG_HEXDUMP(LOG_LEVEL_ERR, _data, _length, _description)
+
+/**
+ * Logs binary data as hexdump with warning level, see `LOG_HEXDUMP()`.
+ */
+#define LOG_HEXDUMP_WRN(_data, _length, _description) LOG_HEXDUMP(LOG_LEVEL_WRN, _data, _length, _description)
+
+/**
+ * Logs binary data as hexdump with info level, see `LOG_HEXDUMP()`.
+ */
+#define LOG_HEXDUMP_INF(_data, _length, _description) LOG_HEXDUMP(LOG_LEVEL_INF, _data, _length, _description)
+
+/**
+ * Logs binary data as hexdump with debug level, see `LOG_HEXDUMP()`.
+ */
+#define LOG_HEXDUMP_DBG(_data, _length, _description) LOG_HEXDUMP(LOG_LEVEL_DBG, _data, _length, _description)
+
+/**
+ * Logs a message with a rate limit for the call site.
+ *
+ * The call site may log `_burst` messages at once, afterwards one message per `_interval_ms`. Further messages are
+ * suppressed. The next logged message is preceded by a message with the number of suppressed messages.
+ *
+ * The macro is safe to use from ISRs.
+ *
+ * @param _level Log level of the message.
+ * @param _burst Number of messages which may be logged at once, at least 1.
+ * @param _interval_ms Time in milliseconds to regain one message.
+ * @param ... Format string and arguments.
+ */
+#define LOG_RATELIMIT(_level, _burst, _interval_ms, ...) \
+    do { \
+        if (((int) (_level) <= __log_compiled_level) && ((_level) <= __log_module.level)) { \
+            static struct log_ratelimit __log_ratelimit; \
+            uint32_t __log_suppressed = 0; \
+            if (log_ratelimit_take(&__log_ratelimit, _burst, _interval_ms, &__log_suppressed)) { \
+                if (__log_suppressed > 0) { \
+                    LOG_MESSAGE(_level, "%u messages suppressed", (unsigned) __log_suppressed); \
+                } \
+                LOG_MESSAGE(_level, __VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
+/**
+ * Logs an error message with the default rate limit for the call site, see `LOG_RATELIMIT()`.
+ */
+#define LOG_ERR_RATELIMIT(...) \
+    LOG_RATELIMIT(LOG_LEVEL_ERR, LOG_RATELIMIT_BURST, LOG_RATELIMIT_INTERVAL_MS, __VA_ARGS__)
+
+/**
+ * Logs a warning message with the default rate limit for the call site, see `LOG_RATELIMIT()`.
+ */
+#define LOG_WRN_RATELIMIT(...) \
+    LOG_RATELIMIT(LOG_LEVEL_WRN, LOG_RATELIMIT_BURST, LOG_RATELIMIT_INTERVAL_MS, __VA_ARGS__)
+
+/**
+ * Logs an info message with the default rate limit for the call site, see `LOG_RATELIMIT()`.
+ */
+#define LOG_INF_RATELIMIT(...) \
+    LOG_RATELIMIT(LOG_LEVEL_INF, LOG_RATELIMIT_BURST, LOG_RATELIMIT_INTERVAL_MS, __VA_ARGS__)
+
+/**
+ * Logs a debug message with the default rate limit for the call site, see `LOG_RATELIMIT()`.
+ */
+#define LOG_DBG_RATELIMIT(...) \
+    LOG_RATELIMIT(LOG_LEVEL_DBG, LOG_RATELIMIT_BURST, LOG_RATELIMIT_INTERVAL_MS, __VA_ARGS__)
 
 /**
  * Changes the log level for a module.
@@ -79,6 +271,37 @@ struct log_module {
  */
 void log_set_level(const char *module_name, enum log_level level);
 
+/**
+ * Switches between text and binary output.
+ *
+ * Text output formats each message on the target. Binary output sends the recorded message as it is, which
+ * is several times shorter, and leaves formatting to the host (see `tools/log_decoder.py`). All pointers in
+ * binary frames (module, format string, string arguments) are resolved by the host using the ELF file of the
+ * running firmware, so strings which are not part of the image cannot be decoded.
+ *
+ * Each frame consists of the sync byte 0xA5, the frame type, the payload length, the payload and an XOR
+ * checksum over type, length and payload. Type 0 carries a log message (header followed by the captured
+ * format string), type 1 the number of dropped messages as 32 bit integer followed by the lane as 8 bit integer,
+ * type 2 a hexdump (header followed by the description string pointer and the data).
+ *
+ * The default is text output unless `LOG_BINARY` is defined.
+ *
+ * @param enabled True for binary output, false for text output.
+ */
+void log_set_binary(bool_t enabled);
+
+/**
+ * Changes the behavior of a log lane when its message buffer is full.
+ *
+ * Dropping the newest message keeps the first messages of a burst, which usually show its cause. Overwriting
+ * the oldest messages keeps the most recent ones. Either way, the number of lost messages is reported per lane.
+ * The default is `LOG_POLICY_DROP_NEWEST` for all lanes.
+ *
+ * @param lane Lane to change.
+ * @param policy New behavior of the lane.
+ */
+void log_set_policy(enum log_lane lane, enum log_policy policy);
+
 /**
  * Immediately flush all pending log messages.
  *
@@ -90,6 +313,9 @@ void log_panic();
  * Creates a log message and writes it to the ring buffer.
  * Submits the log handler work item to process the message.
  *
+ * The level of the module is checked by the logging macros, this function only checks whether a backend
+ * wants the message.
+ *
  * This function is safe to use from ISRs.
  * This function is intended for internal use by logging macros.
  *
@@ -100,6 +326,50 @@ void log_panic();
  */
 void log_message(const struct log_module *module, enum log_level level, const char *format, ...);
 
+/**
+ * Writes a log message with an already captured format string to the ring buffer.
+ * Submits the log handler work item to process the message.
+ *
+ * This function is safe to use from ISRs.
+ * This function is intended for internal use by logging macros.
+ *
+ * @param module Module sending to log message.
+ * @param level Log level of the message.
+ * @param package Captured format string, see `cbprintf_capture`.
+ * @param length Length of the package in bytes.
+ */
+void log_message_package(const struct log_module *module, enum log_level level, const void *package, size_t length);
+
+/**
+ * Writes binary data as hexdump to the ring buffer.
+ * Submits the log handler work item to process the message.
+ *
+ * This function is safe to use from ISRs.
+ * This function is intended for internal use by logging macros.
+ *
+ * @param module Module sending the hexdump.
+ * @param level Log level of the hexdump.
+ * @param data Data to dump.
+ * @param length Length of the data in bytes, truncated to `LOG_HEXDUMP_MAX_LENGTH`.
+ * @param description Description printed before the data, must stay valid.
+ */
+void log_hexdump(const struct log_module *module, enum log_level level, const void *data, size_t length,
+                 const char *description);
+
+/**
+ * Takes a message from the rate limit of a call site.
+ *
+ * This function is safe to use from ISRs.
+ * This function is intended for internal use by logging macros.
+ *
+ * @param limit Rate limit of the call site.
+ * @param burst Number of messages which may be logged at once, at least 1.
+ * @param interval Time in milliseconds to regain one message.
+ * @param suppressed Set to the number of messages suppressed before this one if the message may be logged.
+ * @return True if the message may be logged, false if it is suppressed.
+ */
+bool_t log_ratelimit_take(struct log_ratelimit *limit, uint32_t burst, u32_ms_t interval, uint32_t *suppressed);
+
 /**
  * Registers a new module.
  *
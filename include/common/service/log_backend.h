@@ -0,0 +1,131 @@
+#pragma once
+
+#include <service/log.h>
+#include <service/stream_buffer.h>
+#include <util/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct log_backend;
+
+/**
+ * Functions implemented by a log backend.
+ */
+struct log_backend_api {
+    /**
+     * Starts transmitting a chunk of formatted output.
+     *
+     * The function must not block. Once the chunk is transmitted, the backend calls
+     * `log_backend_transmit_done()`, which may also happen from within this function.
+     * Called with interrupts locked.
+     *
+     * @param backend Backend.
+     * @param data Data to transmit, valid until the transmission is done.
+     * @param length Length of the data in bytes.
+     */
+    void (*transmit)(struct log_backend *backend, const uint8_t *data, size_t length);
+
+    /**
+     * Stops an ongoing transmission before the remaining output is written synchronously.
+     *
+     * Called by `log_panic()` if a transmission is ongoing. Calls to `log_backend_transmit_done()` are ignored
+     * afterwards.
+     *
+     * @param backend Backend.
+     * @return Number of bytes of the ongoing transmission which have already been transmitted.
+     */
+    size_t (*panic)(struct log_backend *backend);
+};
+
+/**
+ * Read state of a log backend in one log lane.
+ */
+struct log_backend_lane {
+    uint32_t position; ///< Position of the next message in the message buffer of the lane.
+    uint32_t dropped_reported; ///< Number of dropped messages of the lane already reported by this backend.
+    u64_us_t timestamp; ///< Timestamp of the last message of the lane read by this backend.
+    uint16_t hexdump_row; ///< Next line of the hexdump being output as text, zero for its first line.
+};
+
+/**
+ * Log backend transmitting formatted output asynchronously.
+ *
+ * The log work item formats messages into the TX buffer of the backend as long as there is space for a full
+ * line and hands contiguous chunks to the backend. When a chunk is transmitted, the log work item continues
+ * formatting, so it never waits for the output.
+ *
+ * All backends read the same log messages, each at its own position. A message is freed once every backend
+ * has passed it, so a slow backend only delays the others when the message buffer runs full. In lanes overwriting
+ * the oldest messages, a slow backend skips the messages freed before it read them.
+ */
+struct log_backend {
+    const struct log_backend_api *api; ///< Backend functions.
+    struct stream_buffer *buffer; ///< TX buffer for formatted output.
+    enum log_level level; ///< Most verbose level output by this backend.
+    size_t transmitting; ///< Length of the chunk being transmitted, zero if idle.
+    bool_t panic; ///< Output is written synchronously, set by `log_panic()`.
+    struct log_backend_lane lanes[LOG_LANE_COUNT]; ///< Read state in each log lane.
+    struct log_backend *next; ///< Next registered backend.
+};
+
+/**
+ * Defines a new log backend.
+ *
+ * The macro expands to multiple definitions and therefore cannot be prefixed with `static`.
+ *
+ * @param _name Name of the defined backend.
+ * @param _api Backend functions, see `struct log_backend_api`.
+ * @param _buffer_size Size of the TX buffer in bytes, must be a power of two.
+ * @param _level Most verbose level output by the backend.
+ */
+#define LOG_BACKEND_DEFINE(_name, _api, _buffer_size, _level) \
+    STREAM_BUFFER_DEFINE(_name##_buffer, _buffer_size); \
+    struct log_backend _name = { _api, &_name##_buffer, _level, 0, false, { { 0, 0, 0, 0 } }, NULL }
+
+/**
+ * Adds a backend to the log output.
+ *
+ * The backend starts with the oldest message which has not been freed yet. As long as no backend is
+ * registered, all messages are written synchronously using `system_debug_out()`.
+ *
+ * Backends are intended to be registered during initialization.
+ *
+ * @param backend Backend which is not registered yet.
+ */
+void log_backend_register(struct log_backend *backend);
+
+/**
+ * Removes a backend from the log output.
+ *
+ * The backend must be idle, e.g. after `log_panic()`.
+ *
+ * @param backend Registered backend.
+ */
+void log_backend_unregister(struct log_backend *backend);
+
+/**
+ * Changes the level filter of a backend.
+ *
+ * Messages are only recorded if their module level and at least one backend let them pass.
+ *
+ * @param backend Backend.
+ * @param level Most verbose level output by the backend.
+ */
+void log_backend_set_level(struct log_backend *backend, enum log_level level);
+
+/**
+ * Notifies that the chunk passed to `transmit` has been transmitted.
+ *
+ * Starts the transmission of the next chunk and resumes the log work item.
+ *
+ * This function is safe to be called from ISRs and other threads.
+ *
+ * @param backend Backend.
+ */
+void log_backend_transmit_done(struct log_backend *backend);
+
+#ifdef __cplusplus
+}
+#endif
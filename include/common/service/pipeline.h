@@ -0,0 +1,167 @@
+#pragma once
+
+#include <service/work.h>
+#include <util/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct pipeline_stage;
+
+/**
+ * Processes one block of a stage.
+ *
+ * @param stage Stage.
+ * @param input Block of the upstream stage, owned by the stage until the function returns.
+ * @param length Length of the input block in bytes.
+ * @param output Free output buffer of `buffer_size` bytes or NULL for stages without output buffers.
+ * @return Length of the output block in bytes, zero if no output block was produced.
+ */
+typedef size_t (*pipeline_process_t)(struct pipeline_stage *stage, const void *input, size_t length, void *output);
+
+/**
+ * Statistics of a stage.
+ */
+struct pipeline_stats {
+    uint32_t blocks; ///< Number of processed (or committed, for sources) blocks.
+    uint32_t bytes; ///< Number of processed (or committed, for sources) bytes.
+    uint32_t stalls; ///< Number of times the stage could not continue because both output buffers were full.
+    u64_us_t since; ///< Uptime at which the statistics were reset.
+};
+
+/**
+ * Stage of a block processing pipeline.
+ *
+ * Each stage owns two output buffers (ping-pong). While the downstream stage processes one of them in place,
+ * the stage can fill the other one, so blocks are handed over without copying. A stage only processes a
+ * block if one of its output buffers is free, otherwise the block stays in the upstream buffer until the
+ * downstream stage released a buffer (backpressure). If both buffers of a source are full, further blocks
+ * are rejected by `pipeline_acquire()`.
+ */
+struct pipeline_stage {
+    struct work work; ///< Work item processing the blocks.
+    pipeline_process_t process; ///< Processing function, NULL for sources filled by `pipeline_acquire()`.
+    struct pipeline_stage *upstream; ///< Stage providing the input blocks.
+    struct pipeline_stage *downstream; ///< Stage consuming the output blocks.
+    uint8_t *buffers[2]; ///< Output buffers.
+    size_t buffer_size; ///< Size of each output buffer in bytes, zero for sinks.
+    size_t lengths[2]; ///< Length of the committed blocks.
+    uint8_t write_index; ///< Index of the next buffer to fill.
+    uint8_t read_index; ///< Index of the next buffer to consume.
+    uint8_t full_count; ///< Number of committed blocks.
+    struct pipeline_stats stats; ///< Statistics.
+};
+
+/**
+ * Defines a new pipeline stage.
+ *
+ * The macro expands to multiple definitions and therefore cannot be prefixed with `static`.
+ *
+ * @param _name Name of the defined stage.
+ * @param _priority Priority of the work item (lower value means higher priority).
+ * @param _process Processing function or NULL for sources.
+ * @param _buffer_size Size of each output buffer in bytes, zero for sinks.
+ */
+#define PIPELINE_STAGE_DEFINE(_name, _priority, _process, _buffer_size) \
+    static uint32_t _name##_buffers[2][((_buffer_size) > 0) ? (((_buffer_size) + 3) / 4) : 1]; \
+    struct pipeline_stage _name = { \
+        WORK_INITIALIZER(_priority, pipeline_stage_handler), _process, NULL, NULL, \
+        { (uint8_t *) _name##_buffers[0], (uint8_t *) _name##_buffers[1] }, _buffer_size, { 0, 0 }, 0, 0, 0, \
+        { 0, 0, 0, 0 }, \
+    }
+
+/**
+ * Defines a new source stage whose buffers are filled by `pipeline_acquire()` and `pipeline_commit()`.
+ *
+ * @param _name Name of the defined stage.
+ * @param _buffer_size Size of each output buffer in bytes.
+ */
+#define PIPELINE_SOURCE_DEFINE(_name, _buffer_size) \
+    PIPELINE_STAGE_DEFINE(_name, WORK_PRIORITY_LOWEST, NULL, _buffer_size)
+
+/**
+ * Connects the output of a stage to the input of another stage.
+ *
+ * Stages are intended to be connected during initialization.
+ *
+ * @param upstream Stage providing the blocks.
+ * @param downstream Stage processing the blocks.
+ */
+void pipeline_connect(struct pipeline_stage *upstream, struct pipeline_stage *downstream);
+
+/**
+ * Gets the free output buffer of a stage to fill it, e.g. from the ADC interrupt feeding a source.
+ *
+ * Only one buffer can be acquired at a time. This function is safe to be called from ISRs.
+ *
+ * @param stage Stage.
+ * @return Buffer of `buffer_size` bytes or NULL if both buffers are full.
+ */
+void *pipeline_acquire(struct pipeline_stage *stage);
+
+/**
+ * Commits the acquired buffer and submits the downstream stage.
+ *
+ * This function is safe to be called from ISRs.
+ *
+ * @param stage Stage.
+ * @param length Length of the block in bytes.
+ */
+void pipeline_commit(struct pipeline_stage *stage, size_t length);
+
+/**
+ * Gets the oldest committed block of a stage without a downstream stage, e.g. to pass it to a DMA transfer.
+ *
+ * @param stage Stage.
+ * @param length Set to the length of the block in bytes.
+ * @return Block or NULL if there is no committed block.
+ */
+const void *pipeline_peek(struct pipeline_stage *stage, size_t *length);
+
+/**
+ * Releases the block returned by `pipeline_peek()` and submits the stage in case it was stalled.
+ *
+ * This function is safe to be called from ISRs.
+ *
+ * @param stage Stage.
+ */
+void pipeline_release(struct pipeline_stage *stage);
+
+/**
+ * Processes one block of a stage if an input block and an output buffer are available.
+ *
+ * Called by the work item of the stage, exposed for stages running on their own thread in the simulator.
+ *
+ * @param stage Stage.
+ * @return True if a block was processed.
+ */
+bool_t pipeline_stage_process(struct pipeline_stage *stage);
+
+/**
+ * Reads the statistics of a stage and resets them.
+ *
+ * @param stage Stage.
+ * @param stats Set to the statistics since the last call.
+ */
+void pipeline_stats_read(struct pipeline_stage *stage, struct pipeline_stats *stats);
+
+/**
+ * Computes the throughput of a stage.
+ *
+ * @param stats Statistics returned by `pipeline_stats_read()`.
+ * @param now Uptime at which the statistics were read.
+ * @return Processed bytes per second.
+ */
+uint32_t pipeline_stats_byte_rate(const struct pipeline_stats *stats, u64_us_t now);
+
+/**
+ * Work handler of pipeline stages.
+ *
+ * @param work Work item of the stage.
+ */
+void pipeline_stage_handler(struct work *work);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <service/system.h>
+#include <util/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Idle time used if there is no scheduled wake-up.
+ */
+#define POWER_IDLE_TIME_INFINITE  UINT64_MAX
+
+/**
+ * Sleep state selection policy.
+ */
+struct power_governor {
+    /**
+     * Resets any state of the governor. Invoked when the governor is activated.
+     */
+    void (*reset)(void);
+
+    /**
+     * Selects the sleep state to enter.
+     *
+     * @param states Sleep states supported by the platform, ordered from shallowest to deepest.
+     * @param count Number of sleep states.
+     * @param idle_time Time until the next scheduled wake-up in microseconds.
+     * @return Index of the selected sleep state.
+     */
+    size_t (*select)(const struct system_sleep_state *states, size_t count, u64_us_t idle_time);
+
+    /**
+     * Informs the governor about the outcome of a sleep period.
+     *
+     * @param state Index of the sleep state which was entered.
+     * @param idle_time Idle time the selection was based on.
+     * @param measured_time Time actually spent sleeping in microseconds.
+     */
+    void (*reflect)(size_t state, u64_us_t idle_time, u64_us_t measured_time);
+};
+
+/**
+ * Default governor.
+ *
+ * Selects the deepest state whose latencies and minimum residency fit into the predicted idle time.
+ * The prediction is the time until the next scheduled wake-up. If most of the recent wake-ups happened
+ * before their scheduled time (e.g. by interrupts), the prediction is lowered to their average duration.
+ */
+extern const struct power_governor power_governor_menu;
+
+/**
+ * Sets the governor used to select sleep states.
+ *
+ * @param governor Governor to use.
+ */
+void power_governor_set(const struct power_governor *governor);
+
+/**
+ * Selects a sleep state using the current governor.
+ *
+ * @param idle_time Time until the next scheduled wake-up in microseconds or `POWER_IDLE_TIME_INFINITE`.
+ * @return Index of the selected sleep state.
+ */
+size_t power_select(u64_us_t idle_time);
+
+/**
+ * Enters the sleep state selected by the current governor and reports the measured sleep time back to it.
+ *
+ * Intended to be called by the work queue with interrupts locked and the wake-up already scheduled.
+ *
+ * @param idle_time Time until the next scheduled wake-up in microseconds or `POWER_IDLE_TIME_INFINITE`.
+ */
+void power_sleep(u64_us_t idle_time);
+
+#ifdef __cplusplus
+}
+#endif
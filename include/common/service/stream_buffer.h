@@ -0,0 +1,255 @@
+#pragma once
+
+#include <service/assert.h>
+#include <util/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Byte ring buffer with zero-copy access.
+ *
+ * The buffer is used either as byte stream or as message buffer, both must not be mixed on the same buffer.
+ *
+ * As byte stream, a single producer writes into reserved regions and commits the number of bytes written.
+ * A single consumer peeks at the committed bytes and consumes them. Neither side needs a lock.
+ *
+ * As message buffer, each message is prefixed with a 32 bit header and padded to 4 bytes. Messages are reserved
+ * by atomically advancing the write position, so multiple producers including ISRs and other threads can
+ * reserve messages concurrently without a lock. Messages are filled in place and committed individually.
+ * The consumer stops at the oldest message which is not yet committed and clears consumed messages, so it
+ * never blocks producers.
+ *
+ * Regions consist of up to two segments, because data might wrap around at the end of the buffer.
+ */
+struct stream_buffer {
+    uint8_t *data; ///< Storage, must be 4 byte aligned.
+    uint32_t size; ///< Size of the storage in bytes, power of two.
+    uint32_t write; ///< Position of the next byte to write.
+    uint32_t read; ///< Position of the next byte to read.
+    uint32_t overflows; ///< Number of messages which did not fit into the buffer.
+};
+
+/**
+ * Region of a stream buffer.
+ */
+struct stream_buffer_region {
+    uint8_t *data[2]; ///< First and second segment.
+    size_t length[2]; ///< Length of the first and second segment in bytes, the second might be zero.
+    uint32_t position; ///< Position of the message header (message buffers only).
+};
+
+/**
+ * Defines a new stream buffer with static storage.
+ *
+ * The macro expands to multiple definitions and therefore cannot be prefixed with `static`.
+ *
+ * @param _name Name of the defined buffer.
+ * @param _size Size in bytes, must be a power of two and at least 4.
+ */
+#define STREAM_BUFFER_DEFINE(_name, _size) \
+    BUILD_ASSERT(((_size) >= 4) && (((_size) & ((_size) - 1)) == 0)); \
+    static uint32_t _name##_data[(_size) / sizeof(uint32_t)]; \
+    struct stream_buffer _name = { (uint8_t *) _name##_data, _size, 0, 0, 0 }
+
+/**
+ * Reserves space to write into a byte stream.
+ *
+ * May only be called by the producer. The region stays valid until committed.
+ *
+ * @param buffer Stream buffer.
+ * @param length Requested number of bytes.
+ * @param region Reserved region.
+ * @return Number of reserved bytes, might be less than requested if the buffer is almost full.
+ */
+size_t stream_buffer_reserve(struct stream_buffer *buffer, size_t length, struct stream_buffer_region *region);
+
+/**
+ * Commits written bytes to the consumer of a byte stream.
+ *
+ * May only be called by the producer.
+ *
+ * @param buffer Stream buffer.
+ * @param length Number of bytes written into the reserved region.
+ */
+void stream_buffer_commit(struct stream_buffer *buffer, size_t length);
+
+/**
+ * Copies bytes into a byte stream.
+ *
+ * May only be called by the producer.
+ *
+ * @param buffer Stream buffer.
+ * @param data Data to write.
+ * @param length Length of the data in bytes.
+ * @return Number of bytes written, might be less than requested if the buffer is almost full.
+ */
+size_t stream_buffer_write(struct stream_buffer *buffer, const void *data, size_t length);
+
+/**
+ * Gets all committed bytes of a byte stream.
+ *
+ * May only be called by the consumer.
+ *
+ * @param buffer Stream buffer.
+ * @param region Region of the committed bytes.
+ * @return Number of committed bytes.
+ */
+size_t stream_buffer_peek(struct stream_buffer *buffer, struct stream_buffer_region *region);
+
+/**
+ * Frees bytes of a byte stream.
+ *
+ * May only be called by the consumer.
+ *
+ * @param buffer Stream buffer.
+ * @param length Number of bytes to free, must not exceed the length returned by `stream_buffer_peek()`.
+ */
+void stream_buffer_consume(struct stream_buffer *buffer, size_t length);
+
+/**
+ * Copies bytes out of a byte stream and frees them.
+ *
+ * May only be called by the consumer.
+ *
+ * @param buffer Stream buffer.
+ * @param data Buffer for the data.
+ * @param length Size of the buffer in bytes.
+ * @return Number of bytes read.
+ */
+size_t stream_buffer_read(struct stream_buffer *buffer, void *data, size_t length);
+
+/**
+ * Reserves a message.
+ *
+ * If there is not enough space, the overflow counter of the buffer is incremented.
+ *
+ * This function is safe to be called from ISRs.
+ *
+ * @param buffer Message buffer.
+ * @param length Length of the message in bytes.
+ * @param region Reserved region for the message content.
+ * @return True on success, false if there is not enough space.
+ */
+bool_t stream_buffer_message_reserve(struct stream_buffer *buffer, size_t length,
+                                     struct stream_buffer_region *region);
+
+/**
+ * Commits a reserved message.
+ *
+ * This function is safe to be called from ISRs.
+ *
+ * @param buffer Message buffer.
+ * @param region Region returned by `stream_buffer_message_reserve()`.
+ */
+void stream_buffer_message_commit(struct stream_buffer *buffer, const struct stream_buffer_region *region);
+
+/**
+ * Copies a message into the buffer.
+ *
+ * This function is safe to be called from ISRs.
+ *
+ * @param buffer Message buffer.
+ * @param data Message content.
+ * @param length Length of the message in bytes.
+ * @return True on success, false if there is not enough space.
+ */
+bool_t stream_buffer_message_put(struct stream_buffer *buffer, const void *data, size_t length);
+
+/**
+ * Gets the oldest message.
+ *
+ * May only be called by the consumer.
+ *
+ * @param buffer Message buffer.
+ * @param region Region of the message content.
+ * @return True if there is a committed message, false otherwise.
+ */
+bool_t stream_buffer_message_peek(struct stream_buffer *buffer, struct stream_buffer_region *region);
+
+/**
+ * Frees the message returned by `stream_buffer_message_peek()`.
+ *
+ * May only be called by the consumer.
+ *
+ * @param buffer Message buffer.
+ */
+void stream_buffer_message_consume(struct stream_buffer *buffer);
+
+/**
+ * Gets the message at a position.
+ *
+ * Allows a consumer to keep several read positions, e.g. one per output. Each position starts at the read
+ * position of the buffer and is advanced with `stream_buffer_message_next()`. Messages stay valid until freed
+ * with `stream_buffer_message_consume_to()`.
+ *
+ * May only be called by the consumer.
+ *
+ * @param buffer Message buffer.
+ * @param position Position of the message, between the read position and the last message.
+ * @param region Region of the message content.
+ * @return True if there is a committed message at the position, false otherwise.
+ */
+bool_t stream_buffer_message_peek_at(struct stream_buffer *buffer, uint32_t position,
+                                     struct stream_buffer_region *region);
+
+/**
+ * Gets the position of the message following a peeked message.
+ *
+ * @param region Region returned by `stream_buffer_message_peek()` or `stream_buffer_message_peek_at()`.
+ * @return Position of the next message.
+ */
+uint32_t stream_buffer_message_next(const struct stream_buffer_region *region);
+
+/**
+ * Frees all messages before a position.
+ *
+ * May only be called by the consumer.
+ *
+ * @param buffer Message buffer.
+ * @param position Position of the first message to keep, obtained by `stream_buffer_message_next()`.
+ */
+void stream_buffer_message_consume_to(struct stream_buffer *buffer, uint32_t position);
+
+/**
+ * Copies data into a region.
+ *
+ * @param region Region to write to.
+ * @param data Data to copy, at least the length of the region.
+ */
+void stream_buffer_region_copy_in(const struct stream_buffer_region *region, const void *data);
+
+/**
+ * Copies data out of a region.
+ *
+ * @param region Region to read from.
+ * @param data Buffer for the data, at least the length of the region.
+ * @return Length of the region in bytes.
+ */
+size_t stream_buffer_region_copy_out(const struct stream_buffer_region *region, void *data);
+
+/**
+ * Copies data into a part of a region.
+ *
+ * @param region Region to write to.
+ * @param offset Offset within the region.
+ * @param data Data to copy.
+ * @param length Number of bytes to copy, must not exceed the region.
+ */
+void stream_buffer_region_write(const struct stream_buffer_region *region, size_t offset, const void *data,
+                                size_t length);
+
+/**
+ * Copies data out of a part of a region.
+ *
+ * @param region Region to read from.
+ * @param offset Offset within the region.
+ * @param data Buffer for the data.
+ * @param length Number of bytes to copy, must not exceed the region.
+ */
+void stream_buffer_region_read(const struct stream_buffer_region *region, size_t offset, void *data, size_t length);
+
+#ifdef __cplusplus
+}
+#endif
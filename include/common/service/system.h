@@ -2,10 +2,74 @@
 
 #include <util/types.h>
 
+/**
+ * Rate of the system tick in Hz.
+ *
+ * The tick is the native time base of the work queue. The rate must be a divisor of 1 MHz. The default
+ * matches the uptime counter of the STM32 so reading the uptime in ticks requires no conversion.
+ */
+#ifndef SYSTEM_TICK_HZ
+#define SYSTEM_TICK_HZ            1000000
+#endif
+
+#if (SYSTEM_TICK_HZ <= 0) || (1000000 % SYSTEM_TICK_HZ != 0)
+#error "SYSTEM_TICK_HZ must be a divisor of 1 MHz"
+#endif
+
+#define SYSTEM_US_PER_TICK        (1000000 / SYSTEM_TICK_HZ)
+
+// greatest common divisor of SYSTEM_US_PER_TICK (a divisor of 2^6 * 5^6) and 1000 (2^3 * 5^3), used to
+// reduce the conversion factors between ticks and milliseconds
+#define SYSTEM_TICK_GCD_MS \
+    ((((SYSTEM_US_PER_TICK % 8) == 0) ? 8 : ((SYSTEM_US_PER_TICK % 4) == 0) ? 4 : \
+      ((SYSTEM_US_PER_TICK % 2) == 0) ? 2 : 1) * \
+     (((SYSTEM_US_PER_TICK % 125) == 0) ? 125 : ((SYSTEM_US_PER_TICK % 25) == 0) ? 25 : \
+      ((SYSTEM_US_PER_TICK % 5) == 0) ? 5 : 1))
+
+/**
+ * Converts milliseconds to ticks.
+ *
+ * Only requires a multiplication (and a shift for tick rates which are not a multiple of 1 kHz).
+ */
+#define SYSTEM_MS_TO_TICKS(_ms) \
+    ((u64_tick_t) (_ms) * (1000 / SYSTEM_TICK_GCD_MS) / (SYSTEM_US_PER_TICK / SYSTEM_TICK_GCD_MS))
+
+/**
+ * Converts ticks to milliseconds (rounding down).
+ */
+#define SYSTEM_TICKS_TO_MS(_ticks) \
+    ((u64_ms_t) (_ticks) * (SYSTEM_US_PER_TICK / SYSTEM_TICK_GCD_MS) / (1000 / SYSTEM_TICK_GCD_MS))
+
+/**
+ * Converts microseconds to ticks (rounding down).
+ */
+#define SYSTEM_US_TO_TICKS(_us)   ((u64_tick_t) (_us) / SYSTEM_US_PER_TICK)
+
+/**
+ * Converts microseconds to ticks (rounding up).
+ */
+#define SYSTEM_US_TO_TICKS_CEIL(_us) \
+    (((u64_tick_t) (_us) + SYSTEM_US_PER_TICK - 1) / SYSTEM_US_PER_TICK)
+
+/**
+ * Converts ticks to microseconds.
+ */
+#define SYSTEM_TICKS_TO_US(_ticks) ((u64_us_t) (_ticks) * SYSTEM_US_PER_TICK)
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * Description of a sleep state provided by the platform.
+ */
+struct system_sleep_state {
+    const char *name; ///< Name of the sleep state.
+    u32_us_t entry_latency; ///< Time needed to enter the sleep state.
+    u32_us_t exit_latency; ///< Time needed to resume execution after a wake-up.
+    u32_us_t min_residency; ///< Minimum time to stay in the sleep state for it to save energy.
+};
+
 /**
  * Globally disables interrupts.
  *
@@ -21,7 +85,7 @@ void system_critical_section_enter(void);
 void system_critical_section_exit(void);
 
 /**
- * Schedules a timer interrupt at the specified uptime.
+ * Schedules a timer interrupt at the specified uptime in ticks.
  *
  * If the timeout is larger than supported by the hardware timer, the timer is scheduled as
  * late as possible and the timer handler is called earlier.
@@ -29,7 +93,7 @@ void system_critical_section_exit(void);
  *
  * @param uptime Uptime at which the interrupt shall occur.
  */
-void system_wakeup_schedule_at(u64_ms_t uptime);
+void system_wakeup_schedule_at(u64_tick_t uptime);
 
 /**
  * Causes the CPU to enter sleep mode until an interrupt occurs.
@@ -39,8 +103,30 @@ void system_wakeup_schedule_at(u64_ms_t uptime);
  * In that case, the pending interrupts are processed after the critical section is exited.
  *
  * A time based wake-up can be scheduled using `system_timer_schedule_at()`.
+ *
+ * @param state Index of the sleep state to enter (see `system_sleep_states_get()`).
+ */
+void system_enter_sleep_mode(size_t state);
+
+/**
+ * Returns the sleep states supported by the platform.
+ *
+ * The states are ordered from the shallowest to the deepest one. There is always at least one state.
+ *
+ * @param states Set to point to the array of sleep states.
+ * @return Number of sleep states.
+ */
+size_t system_sleep_states_get(const struct system_sleep_state **states);
+
+/**
+ * Returns the system up-time.
+ *
+ * The up-time timer is started after peripherals have been initialized before calling into
+ * the `application_main()` function.
+ *
+ * @return System up-time in ticks (see `SYSTEM_TICK_HZ`).
  */
-void system_enter_sleep_mode(void);
+u64_tick_t system_uptime_get_ticks(void);
 
 /**
  * Returns the system up-time.
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <service/work.h>
+#include <util/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Options of a throttle.
+ */
+enum throttle_options {
+    THROTTLE_LEADING = (1 << 0), ///< Submit the target on the first event of a period.
+    THROTTLE_TRAILING = (1 << 1), ///< Submit the target at the end of a period if there were further events.
+};
+
+/**
+ * Throttle limiting the submission of a work item to once per period.
+ *
+ * The first event starts a period. Depending on the options, the target is submitted immediately and/or at the
+ * end of the period if further events happened during the period. A trailing submission starts another period.
+ * All other events are counted as suppressed.
+ */
+struct throttle {
+    struct work work; ///< Internal work item ending the period.
+    struct work *target; ///< Work item to submit.
+    u32_ms_t period; ///< Minimum time between two submissions in milliseconds.
+    uint8_t options; ///< Combination of `enum throttle_options`.
+    bool_t active; ///< True while a period is running.
+    bool_t pending; ///< True if the target will be submitted at the end of the period.
+    uint32_t suppressed; ///< Number of events which did not lead to their own submission.
+};
+
+/**
+ * Initializer for a throttle.
+ *
+ * @param _target Work item to submit.
+ * @param _period Minimum time between two submissions in milliseconds.
+ * @param _options Combination of `enum throttle_options`, at least one must be set.
+ */
+#define THROTTLE_INITIALIZER(_target, _period, _options) \
+    { WORK_INITIALIZER(0, throttle_work_handler), _target, _period, _options, false, false, 0 }
+
+/**
+ * Defines a new throttle.
+ *
+ * @param _name Name of the defined throttle.
+ * @param _target Work item to submit.
+ * @param _period Minimum time between two submissions in milliseconds.
+ * @param _options Combination of `enum throttle_options`, at least one must be set.
+ */
+#define THROTTLE_DEFINE(_name, _target, _period, _options) \
+    struct throttle _name = THROTTLE_INITIALIZER(_target, _period, _options)
+
+/**
+ * Records an event.
+ *
+ * This function is safe to be called from ISRs.
+ *
+ * @param throttle Throttle.
+ */
+void throttle_trigger(struct throttle *throttle);
+
+/**
+ * Ends the current period and drops a pending trailing submission.
+ *
+ * This function is safe to be called from ISRs.
+ *
+ * @param throttle Throttle.
+ */
+void throttle_cancel(struct throttle *throttle);
+
+/**
+ * Work handler of throttles.
+ *
+ * This function is intended for internal use by `THROTTLE_INITIALIZER()`.
+ *
+ * @param work Internal work item of the throttle.
+ */
+void throttle_work_handler(struct work *work);
+
+#ifdef __cplusplus
+}
+#endif
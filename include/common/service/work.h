@@ -9,19 +9,68 @@ extern "C" {
 struct work;
 
 typedef void (*work_handler_t)(struct work *work);
+typedef void (*work_batch_handler_t)(struct work **works, size_t count);
 
 enum work_flags {
     WORK_ITEM_RUNNING = (1 << 0),
     WORK_ITEM_SUBMITTED = (1 << 1),
     WORK_ITEM_SCHEDULED = (1 << 2),
+    WORK_ITEM_IDLE = (1 << 3),
+    WORK_ITEM_ISR = (1 << 4),
+    WORK_ITEM_BATCH = (1 << 5),
 };
 
+#ifndef WORK_IDLE_TIME_SLICE_US
+/**
+ * Time slice for a single invocation of an idle work item in microseconds, see `work_idle_should_yield()`.
+ */
+#define WORK_IDLE_TIME_SLICE_US    1000
+#endif
+
+#ifndef WORK_IDLE_MIN_SLICE_US
+/**
+ * Minimum time in microseconds until the next scheduled item becomes ready for an idle work item to be started.
+ */
+#define WORK_IDLE_MIN_SLICE_US    100
+#endif
+
+#ifndef WORK_BATCH_MAX
+/**
+ * Maximum number of items passed to a single call of a batch handler, see `WORK_BATCH_INITIALIZER()`.
+ */
+#define WORK_BATCH_MAX    8
+#endif
+
+/**
+ * Returned by `work_poll()` if no item is scheduled.
+ */
+#define WORK_POLL_INFINITE    UINT64_MAX
+
+#ifdef WORK_COMPACT_LAYOUT
+/**
+ * The compact layout stores the deadline as wrapped 32 bit uptime in ticks. Scheduled deadlines must therefore
+ * be less than `INT32_MAX` ticks in the future (about 35 minutes with the default `SYSTEM_TICK_HZ`, lower the
+ * tick rate for longer delays). Priorities are limited to 8 bit.
+ */
+typedef uint8_t work_priority_t;
+typedef uint8_t work_flags_t;
+typedef u32_tick_t work_deadline_t;
+
+#define WORK_PRIORITY_LOWEST    UINT8_MAX
+#else
+typedef uint32_t work_priority_t;
+typedef uint32_t work_flags_t;
+typedef u64_tick_t work_deadline_t;
+
+#define WORK_PRIORITY_LOWEST    UINT32_MAX
+#endif
+
 struct work {
     work_handler_t handler;
-    uint32_t priority;
-    u64_ms_t scheduled_uptime;
-    uint32_t flags;
     struct work *next;
+    work_deadline_t scheduled_uptime;
+    work_priority_t priority;
+    work_flags_t flags;
 };
 
 /**
@@ -31,7 +80,7 @@ struct work {
  * @param _handler Function to execute the work.
  */
 #define WORK_INITIALIZER(_priority, _handler) \
-    { _handler, _priority, 0, 0, NULL }
+    { _handler, NULL, 0, _priority, 0 }
 
 /**
  * Defines a new work item.
@@ -43,6 +92,95 @@ struct work {
 #define WORK_DEFINE(_name, _priority, _handler) \
    struct work _name = WORK_INITIALIZER(_priority, _handler)
 
+/**
+ * Initializer for an idle work item.
+ *
+ * Idle items are only executed when no other work is submitted, right before the work queue would go
+ * to sleep. Among each other, they are ordered by priority like regular items.
+ *
+ * @param _priority Priority (lower value means higher priority) relative to other idle items.
+ * @param _handler Function to execute the work.
+ */
+#define WORK_IDLE_INITIALIZER(_priority, _handler) \
+    { _handler, NULL, 0, _priority, WORK_ITEM_IDLE }
+
+/**
+ * Defines a new idle work item.
+ *
+ * @param _name Name of the defined work item.
+ * @param _priority Priority (lower value means higher priority) relative to other idle items.
+ * @param _handler Function to execute the work.
+ */
+#define WORK_IDLE_DEFINE(_name, _priority, _handler) \
+   struct work _name = WORK_IDLE_INITIALIZER(_priority, _handler)
+
+/**
+ * Initializer for a timer item executed in interrupt context.
+ *
+ * Timer items can only be scheduled, not submitted. Their handler is called directly from the wake-up timer
+ * interrupt with interrupts locked once the deadline expires, without waiting for the currently running work
+ * item. Handlers must therefore be very short, e.g. to toggle a pin or start a DMA transfer, and can only use
+ * functions which are safe to be called from ISRs.
+ *
+ * @param _handler Function to execute in interrupt context.
+ */
+#define WORK_ISR_INITIALIZER(_handler) \
+    { _handler, NULL, 0, 0, WORK_ITEM_ISR }
+
+/**
+ * Defines a new timer item executed in interrupt context.
+ *
+ * @param _name Name of the defined work item.
+ * @param _handler Function to execute in interrupt context.
+ */
+#define WORK_ISR_DEFINE(_name, _handler) \
+   struct work _name = WORK_ISR_INITIALIZER(_handler)
+
+/**
+ * Initializer for a work item executed in batches.
+ *
+ * Consecutive submitted batch items with the same handler and priority are removed from the queue together
+ * and passed to a single call of the handler, up to `WORK_BATCH_MAX` items at once. This saves the locking
+ * overhead per item if many items share the same handler, e.g. one item per sample channel.
+ *
+ * The handler is stored in the regular handler field, the cast via `void (*)(void)` avoids warnings about
+ * incompatible function types.
+ *
+ * @param _priority Priority (lower value means higher priority).
+ * @param _handler Function of type `work_batch_handler_t` to execute the work.
+ */
+#define WORK_BATCH_INITIALIZER(_priority, _handler) \
+    { (work_handler_t) (void (*)(void)) (_handler), NULL, 0, _priority, WORK_ITEM_BATCH }
+
+/**
+ * Defines a new work item executed in batches.
+ *
+ * @param _name Name of the defined work item.
+ * @param _priority Priority (lower value means higher priority).
+ * @param _handler Function of type `work_batch_handler_t` to execute the work.
+ */
+#define WORK_BATCH_DEFINE(_name, _priority, _handler) \
+   struct work _name = WORK_BATCH_INITIALIZER(_priority, _handler)
+
+/**
+ * Checks if deadline `a` is before deadline `b`.
+ *
+ * With the compact layout the deadlines wrap around, they are compared relative to each other which is
+ * correct as long as they are less than `INT32_MAX` ticks apart.
+ *
+ * @param a First deadline.
+ * @param b Second deadline.
+ * @return True if `a` is before `b`.
+ */
+static inline bool_t work_deadline_before(work_deadline_t a, work_deadline_t b)
+{
+#ifdef WORK_COMPACT_LAYOUT
+    return (int32_t) (a - b) < 0;
+#else
+    return a < b;
+#endif
+}
+
 /**
  * Enters a loop to execute work items.
  *
@@ -51,6 +189,28 @@ struct work {
  */
 void work_run(void);
 
+/**
+ * Executes the next ready work item without going to sleep.
+ *
+ * Scheduled items which became ready are submitted first. If no regular item is submitted, the first idle
+ * item is executed for one time slice.
+ *
+ * @return True if an item was executed, false if there was no ready item.
+ */
+bool_t work_run_once(void);
+
+/**
+ * Executes ready work items and returns the time until more work is ready.
+ *
+ * Intended to embed the work queue into an external event loop, which calls this function and then waits
+ * for its own events for at most the returned time instead of calling `work_run()`. All submitted items are
+ * executed, idle items get one time slice per call.
+ *
+ * @return Time in microseconds until the next scheduled item is ready, zero if there is ready work left or
+ *         `WORK_POLL_INFINITE` if no item is scheduled.
+ */
+u64_us_t work_poll(void);
+
 #ifdef BUILD_UNIT_TEST
 /**
  * Enters a loop to execute work items for the specified duration.
@@ -78,6 +238,8 @@ void work_run_for(u32_ms_t duration);
  * Note that work items are always executed until completion. This means that an already running low
  * priority item may delay a submitted high priority item.
  *
+ * Items defined with `WORK_ISR_INITIALIZER()` must not be submitted.
+ *
  * This function is safe to be called from ISRs.
  *
  * @param work Item to submit.
@@ -123,6 +285,26 @@ void work_schedule_again(struct work *work, u32_ms_t delay);
  */
 void work_schedule_at(struct work *work, u64_ms_t uptime);
 
+/**
+ * Checks if the currently running idle work item should return.
+ *
+ * Idle items are expected to split their work into small steps and check this function in between. If it
+ * returns true, the item should submit itself again to continue later and return. This is the case once other
+ * work was submitted, the time slice of `WORK_IDLE_TIME_SLICE_US` has elapsed or the next scheduled item
+ * becomes ready, whichever happens first.
+ *
+ * @return True if the running idle item should return, false if it may continue.
+ */
+bool_t work_idle_should_yield(void);
+
+/**
+ * Executes all expired timer items defined with `WORK_ISR_INITIALIZER()`.
+ *
+ * Has to be called by the system implementation from the interrupt of the wake-up timer programmed by
+ * `system_wakeup_schedule_at()`. Afterwards, the wake-up timer is programmed for the next timer item.
+ */
+void work_wakeup_handler(void);
+
 /**
  * Removes an item from the submitted or scheduled queue.
  *
@@ -15,3 +15,5 @@ typedef uint32_t u32_us_t;   ///< time in microseconds (32 bit unsigned)
 typedef int32_t i32_us_t;    ///< time in microseconds (32 bit signed)
 typedef uint64_t u64_us_t;   ///< time in microseconds (64 bit unsigned)
 typedef int64_t i64_us_t;    ///< time in microseconds (64 bit signed)
+typedef uint32_t u32_tick_t; ///< time in system ticks (32 bit unsigned)
+typedef uint64_t u64_tick_t; ///< time in system ticks (64 bit unsigned)
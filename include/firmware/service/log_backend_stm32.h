@@ -0,0 +1,18 @@
+#pragma once
+
+#include <service/log_backend.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Registers the log backend transmitting via the debug UART in interrupt mode.
+ *
+ * Must be called after the UART is initialized.
+ */
+void log_backend_stm32_setup(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <service/completion.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Maximum number of threads which can wait for completions at the same time.
+ */
+#define COMPLETION_SIM_MAX_WAITERS    8
+
+/**
+ * Blocks the calling thread until a completion is signaled.
+ *
+ * Returns immediately if the completion is already done. Each call registers its own continuation, so any
+ * number of threads up to `COMPLETION_SIM_MAX_WAITERS` can wait for the same or different completions. Must not
+ * be called from the work queue thread, which would never get to signal the completion.
+ *
+ * @param completion Completion.
+ */
+void completion_wait(struct completion *completion);
+
+#ifdef __cplusplus
+}
+#endif
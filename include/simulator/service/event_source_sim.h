@@ -0,0 +1,122 @@
+#pragma once
+
+#include <service/work.h>
+#include <util/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Passed to `event_source_wait()` to wait without timeout.
+ */
+#define EVENT_SOURCE_WAIT_INFINITE    UINT64_MAX
+
+/**
+ * File descriptor which submits a work item once it is ready.
+ *
+ * All sources are waited for by the work queue thread while it sleeps, so ready file descriptors are
+ * handled by the work queue without a separate thread. Other threads wake up the work queue by leaving the
+ * critical section, see `event_source_notify()`.
+ */
+struct event_source {
+    struct work *work; ///< Work item submitted once the file descriptor is ready.
+    int fd; ///< File descriptor or -1 if not added.
+    uint32_t ready; ///< Ready epoll events since the last call of `event_source_ready()`.
+};
+
+/**
+ * Initializer for an event source.
+ *
+ * @param _work Work item submitted once the file descriptor is ready.
+ */
+#define EVENT_SOURCE_INITIALIZER(_work) \
+    { _work, -1, 0 }
+
+/**
+ * Defines a new event source.
+ *
+ * @param _name Name of the defined event source.
+ * @param _work Work item submitted once the file descriptor is ready.
+ */
+#define EVENT_SOURCE_DEFINE(_name, _work) \
+    struct event_source _name = EVENT_SOURCE_INITIALIZER(_work)
+
+/**
+ * Creates the epoll instance and the notification, called by `system_setup()`.
+ */
+void event_source_setup(void);
+
+/**
+ * Starts waiting for a file descriptor.
+ *
+ * Sources are level triggered, the work item is submitted again as long as the condition persists.
+ *
+ * @param source Event source which is not added yet.
+ * @param fd File descriptor.
+ * @param events Epoll events to wait for, e.g. `EPOLLIN`.
+ */
+void event_source_add(struct event_source *source, int fd, uint32_t events);
+
+/**
+ * Stops waiting for the file descriptor of a source, the file descriptor is not closed.
+ *
+ * @param source Event source.
+ */
+void event_source_remove(struct event_source *source);
+
+/**
+ * Reads and clears the ready events of a source, intended to be called by its work item.
+ *
+ * @param source Event source.
+ * @return Ready epoll events since the last call.
+ */
+uint32_t event_source_ready(struct event_source *source);
+
+/**
+ * Starts a timer backed by a timerfd, the source is added if necessary.
+ *
+ * @param source Event source which is either not added or was added by this function.
+ * @param delay Delay until the first expiration in milliseconds.
+ * @param period Period of further expirations in milliseconds, zero for a single expiration.
+ */
+void event_source_timer_start(struct event_source *source, u32_ms_t delay, u32_ms_t period);
+
+/**
+ * Stops a timer, the source stays added.
+ *
+ * @param source Event source of the timer.
+ */
+void event_source_timer_stop(struct event_source *source);
+
+/**
+ * Reads the number of expirations of a timer since the last call.
+ *
+ * @param source Event source of the timer.
+ * @return Number of expirations.
+ */
+uint64_t event_source_timer_read(struct event_source *source);
+
+/**
+ * Ends the current or next `event_source_wait()` of another thread.
+ *
+ * Called by the simulated critical section whenever a thread leaves it, as it may have submitted work or
+ * scheduled a wake-up, like an interrupt ends the sleep mode of the target. Does nothing when called by the
+ * waiting thread itself.
+ */
+void event_source_notify(void);
+
+/**
+ * Waits until a file descriptor is ready, another thread called `event_source_notify()` or the timeout expired
+ * and submits the work items of ready sources.
+ *
+ * Used by the simulated sleep mode. External loops can combine it with `work_poll()` instead of `work_run()`.
+ * Must not be called from within the critical section, which other threads need to submit work.
+ *
+ * @param timeout Timeout in microseconds or `EVENT_SOURCE_WAIT_INFINITE`.
+ */
+void event_source_wait(u64_us_t timeout);
+
+#ifdef __cplusplus
+}
+#endif
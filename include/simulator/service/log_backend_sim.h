@@ -0,0 +1,19 @@
+#pragma once
+
+#include <service/log_backend.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Starts the log backend writing to stdout from a separate thread and registers it.
+ *
+ * Completed writes are reported back through an event source, so the log continues in the work queue
+ * thread. Must be called after `system_setup()`.
+ */
+void log_backend_sim_setup(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <service/pipeline.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Maximum number of stages which can be pinned to a thread.
+ */
+#define PIPELINE_SIM_MAX_THREADS    4
+
+/**
+ * Moves the processing of a stage from the work queue to a dedicated thread.
+ *
+ * The stage is still triggered by submitting its work item, which wakes up the thread instead of processing
+ * the block. Has to be called during initialization before blocks are passed to the stage.
+ *
+ * @param stage Stage.
+ */
+void pipeline_stage_pin_thread(struct pipeline_stage *stage);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <service/log_backend.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Fake log backend writing transmitted chunks to `system_debug_out()`.
+ *
+ * Chunks are either transmitted immediately or held back until `log_backend_fake_complete()` is called.
+ */
+extern struct log_backend log_backend_fake;
+
+/**
+ * Resets the fake backend, discarding any pending output and letting all levels pass.
+ *
+ * @param auto_complete True to complete transmissions immediately, false to complete them manually.
+ */
+void log_backend_fake_reset(bool_t auto_complete);
+
+/**
+ * Returns the length of the chunk being transmitted.
+ *
+ * @return Length in bytes, zero if the backend is idle.
+ */
+size_t log_backend_fake_pending(void);
+
+/**
+ * Completes the ongoing transmission.
+ *
+ * The chunk is written to `system_debug_out()` and the next chunk is started if there is one.
+ */
+void log_backend_fake_complete(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <service/system.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Fake sleep states provided by the unit test system implementation.
+ */
+enum system_fake_sleep_state {
+    SYSTEM_FAKE_SLEEP = 0, ///< No latencies.
+    SYSTEM_FAKE_STOP = 1, ///< 50 us entry, 100 us exit latency, 1 ms minimum residency.
+    SYSTEM_FAKE_STANDBY = 2, ///< 1 ms entry, 5 ms exit latency, 100 ms minimum residency.
+};
+
+/**
+ * Returns the sleep state entered by the last call to `system_enter_sleep_mode()`.
+ *
+ * @return Index of the sleep state.
+ */
+size_t system_fake_last_sleep_state(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -2,10 +2,13 @@
 #include <application/peripherals.h>
 #include <driver/gpio.h>
 #include <service/work.h>
+#include <service/debounce.h>
 #include <service/system.h>
 #include <service/log.h>
 #include <util/unused.h>
 
+#define BUTTON_DEBOUNCE_MS  50
+
 LOG_MODULE_REGISTER(application_main);
 
 static void gpio_exti_handler(struct gpio_pin *pin);
@@ -14,6 +17,7 @@ static void low_prio_handler(struct work *work);
 
 WORK_DEFINE(high_prio, 0, high_prio_handler);
 WORK_DEFINE(low_prio, 5, low_prio_handler);
+DEBOUNCE_DEFINE(button_debounce, &high_prio, BUTTON_DEBOUNCE_MS);
 
 void application_main(void)
 {
@@ -28,20 +32,21 @@ static void gpio_exti_handler(struct gpio_pin *pin)
 {
     ARG_UNUSED(pin);
 
-    u64_us_t start = system_uptime_get_us();
-    LOG_ERR("Button ISR: %04u %s!", 42, "argtest");
-    u64_us_t end = system_uptime_get_us();
-
-    work_submit(&high_prio);
-
-    LOG_INF("Logging took %u us", (unsigned) (end - start));
+    // every bounce of the button triggers an interrupt
+    debounce_trigger(&button_debounce);
 }
 
 void high_prio_handler(struct work *work)
 {
     ARG_UNUSED(work);
 
-    LOG_WRN("HIGH start");
+    // the counter is cumulative, report the bounces of this press only
+    system_critical_section_enter();
+    uint32_t bounces = button_debounce.suppressed;
+    button_debounce.suppressed = 0;
+    system_critical_section_exit();
+
+    LOG_WRN("HIGH start (%u bounces suppressed)", (unsigned) bounces);
     system_busy_sleep_ms(500);
     LOG_WRN("HIGH done");
 }
@@ -0,0 +1,67 @@
+#include <service/active_object.h>
+#include <util/container_of.h>
+
+void active_object_start(struct active_object *object)
+{
+    hsm_init(&object->hsm);
+
+    // dispatch events posted before the start
+    work_submit(&object->work);
+}
+
+bool_t active_object_post(struct active_object *object, uint32_t signal, uint32_t param)
+{
+    struct hsm_event event = {
+        .signal = signal,
+        .param = param,
+    };
+
+    return channel_send(object->queue, &event);
+}
+
+struct active_object *active_object_from_hsm(struct hsm *hsm)
+{
+    return CONTAINER_OF(hsm, struct active_object, hsm);
+}
+
+void active_object_timer_start(struct active_object_timer *timer, u32_ms_t delay)
+{
+    work_cancel(&timer->work);
+    work_schedule_after(&timer->work, delay);
+}
+
+void active_object_timer_stop(struct active_object_timer *timer)
+{
+    work_cancel(&timer->work);
+}
+
+void active_object_work_handler(struct work *work)
+{
+    struct active_object *object = CONTAINER_OF(work, struct active_object, work);
+
+    if (object->hsm.current == NULL) {
+        // not started yet
+        return;
+    }
+
+    struct hsm_event event;
+
+    if (!channel_receive(object->queue, &event)) {
+        return;
+    }
+
+    hsm_dispatch(&object->hsm, &event);
+
+    // one event per invocation, so higher priority work is not delayed by a long queue
+    if (channel_peek(object->queue) != NULL) {
+        work_submit(work);
+    }
+}
+
+void active_object_timer_handler(struct work *work)
+{
+    struct active_object_timer *timer = CONTAINER_OF(work, struct active_object_timer, work);
+
+    // dropped events are counted by the event queue
+    active_object_post(timer->object, timer->event.signal, timer->event.param);
+}
@@ -0,0 +1,98 @@
+#include <service/bus.h>
+#include <service/system.h>
+#include <string.h>
+
+void bus_subscribe(struct bus_topic *topic, struct bus_subscriber *subscriber)
+{
+    system_critical_section_enter();
+
+    struct bus_subscriber **last = &topic->subscribers;
+
+    // append to notify in order of subscription
+    while (*last != NULL) {
+        last = &(*last)->next;
+    }
+
+    subscriber->next = NULL;
+    *last = subscriber;
+
+    system_critical_section_exit();
+}
+
+void bus_publish(struct bus_topic *topic, const void *message)
+{
+    u64_us_t now = system_uptime_get_us();
+
+    system_critical_section_enter();
+
+    memcpy(topic->message, message, topic->message_size);
+    topic->sequence++;
+    topic->published = now;
+    topic->stats.publish_count++;
+
+    struct bus_subscriber *subscriber = topic->subscribers;
+
+    while (subscriber != NULL) {
+        if (subscriber->work != NULL) {
+            work_submit(subscriber->work);
+        }
+
+        if (subscriber->callback != NULL) {
+            subscriber->callback(topic, topic->message);
+        }
+
+        subscriber = subscriber->next;
+    }
+
+    system_critical_section_exit();
+}
+
+uint32_t bus_read(struct bus_topic *topic, void *message)
+{
+    u64_us_t now = system_uptime_get_us();
+
+    system_critical_section_enter();
+
+    memcpy(message, topic->message, topic->message_size);
+
+    uint32_t sequence = topic->sequence;
+
+    if (sequence != 0) {
+        u64_us_t latency = now - topic->published;
+
+        if (latency > topic->stats.latency_max) {
+            topic->stats.latency_max = (latency > UINT32_MAX) ? UINT32_MAX : (u32_us_t) latency;
+        }
+
+        topic->stats.latency_sum += latency;
+        topic->stats.latency_count++;
+    }
+
+    system_critical_section_exit();
+
+    return sequence;
+}
+
+void bus_stats_read(struct bus_topic *topic, struct bus_topic_stats *stats)
+{
+    u64_us_t now = system_uptime_get_us();
+
+    system_critical_section_enter();
+
+    *stats = topic->stats;
+    memset(&topic->stats, 0, sizeof(topic->stats));
+    topic->stats.since = now;
+
+    system_critical_section_exit();
+}
+
+uint32_t bus_stats_publish_rate(const struct bus_topic_stats *stats, u64_us_t now)
+{
+    u64_us_t duration = now - stats->since;
+
+    if (duration == 0) {
+        return 0;
+    }
+
+    return (uint32_t) (((u64_us_t) stats->publish_count * 1000000) / duration);
+}
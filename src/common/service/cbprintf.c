@@ -239,23 +239,13 @@ size_t cbvprintf_capture(void *packaged, size_t length, const char *format, va_l
             switch (fspec->specifier) {
                 case SPECIFIER_SIGNED_DEC:
                     switch (fspec->length) {
-                        case LENGTH_NONE: {
+                        case LENGTH_NONE:
+                        case LENGTH_HH: // char is promoted to int, it is stored like that to match static packages
+                        case LENGTH_H: { // short is promoted to int, it is stored like that to match static packages
                             int value = va_arg(ap, int);
                             buffer_write(&buffer, &value, sizeof(value));
                             break;
                         }
-                        case LENGTH_HH: {
-                            // char is promoted to int when passed to variadic function
-                            char value = (char) va_arg(ap, int);
-                            buffer_write(&buffer, &value, sizeof(value));
-                            break;
-                        }
-                        case LENGTH_H: {
-                            // short is promoted to int when passed to variadic function
-                            short value = (short) va_arg(ap, int);
-                            buffer_write(&buffer, &value, sizeof(value));
-                            break;
-                        }
                         case LENGTH_L: {
                             long value = va_arg(ap, long);
                             buffer_write(&buffer, &value, sizeof(value));
@@ -280,23 +270,13 @@ size_t cbvprintf_capture(void *packaged, size_t length, const char *format, va_l
                 case SPECIFIER_UNSIGNED_DEC:
                 case SPECIFIER_UNSIGNED_HEX:
                     switch (fspec->length) {
-                        case LENGTH_NONE: {
+                        case LENGTH_NONE:
+                        case LENGTH_HH: // char is promoted to int, it is stored like that to match static packages
+                        case LENGTH_H: { // short is promoted to int, it is stored like that to match static packages
                             int value = va_arg(ap, int);
                             buffer_write(&buffer, &value, sizeof(value));
                             break;
                         }
-                        case LENGTH_HH: {
-                            // char is promoted to int when passed to variadic function
-                            char value = (char) va_arg(ap, int);
-                            buffer_write(&buffer, &value, sizeof(value));
-                            break;
-                        }
-                        case LENGTH_H: {
-                            // short is promoted to int when passed to variadic function
-                            short value = (short) va_arg(ap, int);
-                            buffer_write(&buffer, &value, sizeof(value));
-                            break;
-                        }
                         case LENGTH_L: {
                             long value = va_arg(ap, long);
                             buffer_write(&buffer, &value, sizeof(value));
@@ -406,15 +386,15 @@ void cbprintf_restore(cbprintf_out_t out, void *ctx, const void *packaged, size_
                             break;
                         }
                         case LENGTH_HH: {
-                            char temp = 0;
+                            int temp = 0;
                             value_read = buffer_read(&buffer, &temp, sizeof(temp));
-                            value.signed_int = temp;
+                            value.signed_int = (signed char) temp;
                             break;
                         }
                         case LENGTH_H: {
-                            short temp = 0;
+                            int temp = 0;
                             value_read = buffer_read(&buffer, &temp, sizeof(temp));
-                            value.signed_int = temp;
+                            value.signed_int = (short) temp;
                             break;
                         }
                         case LENGTH_L: {
@@ -452,15 +432,15 @@ void cbprintf_restore(cbprintf_out_t out, void *ctx, const void *packaged, size_
                             break;
                         }
                         case LENGTH_HH: {
-                            unsigned char temp = 0;
+                            unsigned int temp = 0;
                             value_read = buffer_read(&buffer, &temp, sizeof(temp));
-                            value.unsigned_int = temp;
+                            value.unsigned_int = (unsigned char) temp;
                             break;
                         }
                         case LENGTH_H: {
-                            unsigned short temp = 0;
+                            unsigned int temp = 0;
                             value_read = buffer_read(&buffer, &temp, sizeof(temp));
-                            value.unsigned_int = temp;
+                            value.unsigned_int = (unsigned short) temp;
                             break;
                         }
                         case LENGTH_L: {
@@ -0,0 +1,200 @@
+#include <service/channel.h>
+#include <string.h>
+
+static void *reserve_spsc(struct channel *channel);
+static void *reserve_mpsc(struct channel *channel);
+static void update_high_watermark(struct channel *channel, uint32_t count);
+static uint32_t element_index(struct channel *channel, void *element);
+static void *element_at(struct channel *channel, uint32_t position);
+
+void *channel_reserve(struct channel *channel)
+{
+    void *element;
+
+    if (channel->type == CHANNEL_MPSC) {
+        element = reserve_mpsc(channel);
+    } else {
+        element = reserve_spsc(channel);
+    }
+
+    if (element == NULL) {
+        __atomic_fetch_add(&channel->overflows, 1, __ATOMIC_RELAXED);
+    }
+
+    return element;
+}
+
+void channel_commit(struct channel *channel, void *element)
+{
+    if (channel->type == CHANNEL_MPSC) {
+        // the sequence number still marks the element as reserved, advance it to committed
+        uint32_t index = element_index(channel, element);
+        uint32_t sequence = __atomic_load_n(&channel->sequence[index], __ATOMIC_RELAXED);
+        __atomic_store_n(&channel->sequence[index], sequence + 1, __ATOMIC_RELEASE);
+    } else {
+        uint32_t tail = __atomic_load_n(&channel->tail, __ATOMIC_RELAXED);
+        __atomic_store_n(&channel->tail, tail + 1, __ATOMIC_RELEASE);
+    }
+
+    if (channel->consumer != NULL) {
+        work_submit(channel->consumer);
+    }
+}
+
+bool_t channel_send(struct channel *channel, const void *element)
+{
+    void *reserved = channel_reserve(channel);
+
+    if (reserved == NULL) {
+        return false;
+    }
+
+    memcpy(reserved, element, channel->element_size);
+    channel_commit(channel, reserved);
+
+    return true;
+}
+
+void *channel_peek(struct channel *channel)
+{
+    uint32_t head = channel->head;
+
+    if (channel->type == CHANNEL_MPSC) {
+        uint32_t index = head & (channel->capacity - 1);
+        uint32_t sequence = __atomic_load_n(&channel->sequence[index], __ATOMIC_ACQUIRE) + index;
+
+        if (sequence != head + 1) {
+            return NULL;
+        }
+    } else if (__atomic_load_n(&channel->tail, __ATOMIC_ACQUIRE) == head) {
+        return NULL;
+    }
+
+    return element_at(channel, head);
+}
+
+void channel_release(struct channel *channel)
+{
+    uint32_t head = channel->head;
+
+    if (channel->type == CHANNEL_MPSC) {
+        // free the element for the producers of the next lap
+        uint32_t index = head & (channel->capacity - 1);
+        __atomic_store_n(&channel->sequence[index], head + channel->capacity - index, __ATOMIC_RELEASE);
+    }
+
+    __atomic_store_n(&channel->head, head + 1, __ATOMIC_RELEASE);
+}
+
+bool_t channel_receive(struct channel *channel, void *element)
+{
+    void *next = channel_peek(channel);
+
+    if (next == NULL) {
+        return false;
+    }
+
+    memcpy(element, next, channel->element_size);
+    channel_release(channel);
+
+    return true;
+}
+
+/**
+ * Reserves the next element of a single producer channel.
+ *
+ * @param channel Channel.
+ * @return Element or NULL if the channel is full.
+ */
+static void *reserve_spsc(struct channel *channel)
+{
+    uint32_t tail = channel->tail;
+    uint32_t count = tail - __atomic_load_n(&channel->head, __ATOMIC_ACQUIRE);
+
+    if (count >= channel->capacity) {
+        return NULL;
+    }
+
+    update_high_watermark(channel, count + 1);
+
+    return element_at(channel, tail);
+}
+
+/**
+ * Reserves the next element of a multi producer channel.
+ *
+ * The sequence number of an element is stored relative to its index, so a zero initialized channel is valid.
+ * It equals the position if the element is free, the position + 1 if it is committed and the position of
+ * the next lap once it is released.
+ *
+ * @param channel Channel.
+ * @return Element or NULL if the channel is full.
+ */
+static void *reserve_mpsc(struct channel *channel)
+{
+    uint32_t tail = __atomic_load_n(&channel->tail, __ATOMIC_RELAXED);
+
+    while (true) {
+        uint32_t index = tail & (channel->capacity - 1);
+        uint32_t sequence = __atomic_load_n(&channel->sequence[index], __ATOMIC_ACQUIRE) + index;
+        int32_t difference = (int32_t) (sequence - tail);
+
+        if (difference < 0) {
+            // element of the previous lap not yet released
+            return NULL;
+        }
+
+        if (difference == 0) {
+            if (__atomic_compare_exchange_n(&channel->tail, &tail, tail + 1, true, __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED)) {
+                update_high_watermark(channel, tail + 1 - __atomic_load_n(&channel->head, __ATOMIC_RELAXED));
+                return element_at(channel, tail);
+            }
+
+            // failed exchange updated tail, retry
+        } else {
+            // another producer reserved the element in the meantime
+            tail = __atomic_load_n(&channel->tail, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/**
+ * Helper function to raise the high watermark of a channel.
+ *
+ * @param channel Channel.
+ * @param count Current number of reserved and committed elements.
+ */
+static void update_high_watermark(struct channel *channel, uint32_t count)
+{
+    uint32_t current = __atomic_load_n(&channel->high_watermark, __ATOMIC_RELAXED);
+
+    while ((count > current) && !__atomic_compare_exchange_n(&channel->high_watermark, &current, count, true,
+                                                             __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        // failed exchange updated current, retry
+    }
+}
+
+/**
+ * Helper function to get the index of an element.
+ *
+ * @param channel Channel.
+ * @param element Element of the channel.
+ * @return Index of the element.
+ */
+static uint32_t element_index(struct channel *channel, void *element)
+{
+    return (uint32_t) ((uint8_t *) element - channel->buffer) / channel->element_size;
+}
+
+/**
+ * Helper function to get the element at a position.
+ *
+ * @param channel Channel.
+ * @param position Position, wrapped by the capacity.
+ * @return Element.
+ */
+static void *element_at(struct channel *channel, uint32_t position)
+{
+    return channel->buffer + (size_t) (position & (channel->capacity - 1)) * channel->element_size;
+}
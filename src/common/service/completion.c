@@ -0,0 +1,95 @@
+#include <service/completion.h>
+#include <service/system.h>
+#include <util/container_of.h>
+
+void completion_complete(struct completion *completion)
+{
+    system_critical_section_enter();
+
+    completion->done = true;
+    completion->count++;
+
+    struct completion_continuation *continuation = completion->continuations;
+    completion->continuations = NULL;
+
+    while (continuation != NULL) {
+        struct completion_continuation *next = continuation->next;
+
+        continuation->next = NULL;
+        continuation->waiting = false;
+        work_submit(&continuation->work);
+
+        continuation = next;
+    }
+
+    system_critical_section_exit();
+}
+
+void completion_reset(struct completion *completion)
+{
+    system_critical_section_enter();
+    completion->done = false;
+    system_critical_section_exit();
+}
+
+bool_t completion_is_done(const struct completion *completion)
+{
+    return __atomic_load_n(&completion->done, __ATOMIC_ACQUIRE);
+}
+
+void completion_then(struct completion *completion, struct completion_continuation *continuation)
+{
+    system_critical_section_enter();
+
+    if (completion->done) {
+        work_submit(&continuation->work);
+    } else if (!continuation->waiting) {
+        struct completion_continuation **last = &completion->continuations;
+
+        // append to keep the order of registration
+        while (*last != NULL) {
+            last = &(*last)->next;
+        }
+
+        *last = continuation;
+        continuation->next = NULL;
+        continuation->waiting = true;
+    }
+
+    system_critical_section_exit();
+}
+
+void completion_cancel(struct completion *completion, struct completion_continuation *continuation)
+{
+    system_critical_section_enter();
+
+    if (continuation->waiting) {
+        struct completion_continuation **current = &completion->continuations;
+
+        while (*current != continuation) {
+            current = &(*current)->next;
+        }
+
+        *current = continuation->next;
+        continuation->next = NULL;
+        continuation->waiting = false;
+    }
+
+    system_critical_section_exit();
+}
+
+void completion_work_submit(struct completion_work *work)
+{
+    system_critical_section_enter();
+    completion_reset(&work->completion);
+    work_submit(&work->work);
+    system_critical_section_exit();
+}
+
+void completion_work_handler(struct work *work)
+{
+    struct completion_work *completion_work = CONTAINER_OF(work, struct completion_work, work);
+
+    completion_work->handler(work);
+    completion_complete(&completion_work->completion);
+}
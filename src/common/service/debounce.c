@@ -0,0 +1,61 @@
+#include <service/debounce.h>
+#include <service/system.h>
+#include <util/container_of.h>
+
+void debounce_trigger(struct debounce *debounce)
+{
+    // ticks avoid a division in the ISR, they are converted by the work handler
+    u64_tick_t current_uptime = system_uptime_get_ticks();
+
+    system_critical_section_enter();
+
+    debounce->last_event = current_uptime;
+
+    if (debounce->pending) {
+        debounce->suppressed++;
+    } else {
+        debounce->pending = true;
+        work_schedule_after(&debounce->work, debounce->quiet_period);
+    }
+
+    system_critical_section_exit();
+}
+
+void debounce_cancel(struct debounce *debounce)
+{
+    system_critical_section_enter();
+
+    debounce->pending = false;
+    work_cancel(&debounce->work);
+
+    system_critical_section_exit();
+}
+
+void debounce_work_handler(struct work *work)
+{
+    struct debounce *debounce = CONTAINER_OF(work, struct debounce, work);
+    u64_tick_t current_uptime = system_uptime_get_ticks();
+
+    system_critical_section_enter();
+
+    if (debounce->pending) {
+        u64_tick_t quiet_end = debounce->last_event + SYSTEM_MS_TO_TICKS(debounce->quiet_period);
+
+        // wait again if there were further events in the meantime
+        if (current_uptime < quiet_end) {
+            u64_ms_t remaining = SYSTEM_TICKS_TO_MS(quiet_end - current_uptime);
+
+            // round up, the quiet period must not end early
+            if (SYSTEM_MS_TO_TICKS(remaining) < quiet_end - current_uptime) {
+                remaining++;
+            }
+
+            work_schedule_after(&debounce->work, (u32_ms_t) remaining);
+        } else {
+            debounce->pending = false;
+            work_submit(debounce->target);
+        }
+    }
+
+    system_critical_section_exit();
+}
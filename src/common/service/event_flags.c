@@ -0,0 +1,139 @@
+#include <service/event_flags.h>
+#include <service/system.h>
+#include <util/container_of.h>
+
+static bool_t try_wake_locked(struct event_flags *event_flags, struct event_waiter *waiter);
+static void remove_locked(struct event_flags *event_flags, struct event_waiter *waiter);
+
+void event_flags_post(struct event_flags *event_flags, uint32_t bits)
+{
+    system_critical_section_enter();
+
+    event_flags->flags |= bits;
+
+    struct event_waiter **current = &event_flags->waiters;
+
+    // submit and unlink matching waiters in a single pass
+    while (*current != NULL) {
+        struct event_waiter *waiter = *current;
+
+        if (try_wake_locked(event_flags, waiter)) {
+            *current = waiter->next;
+            waiter->next = NULL;
+            waiter->waiting = false;
+        } else {
+            current = &waiter->next;
+        }
+    }
+
+    system_critical_section_exit();
+}
+
+void event_flags_clear(struct event_flags *event_flags, uint32_t bits)
+{
+    system_critical_section_enter();
+    event_flags->flags &= ~bits;
+    system_critical_section_exit();
+}
+
+uint32_t event_flags_get(struct event_flags *event_flags)
+{
+    system_critical_section_enter();
+    uint32_t flags = event_flags->flags;
+    system_critical_section_exit();
+
+    return flags;
+}
+
+void event_flags_wait(struct event_flags *event_flags, struct event_waiter *waiter)
+{
+    system_critical_section_enter();
+
+    if (!waiter->waiting && !try_wake_locked(event_flags, waiter)) {
+        struct event_waiter **last = &event_flags->waiters;
+
+        // append to keep the order of registration
+        while (*last != NULL) {
+            last = &(*last)->next;
+        }
+
+        *last = waiter;
+        waiter->next = NULL;
+        waiter->waiting = true;
+    }
+
+    system_critical_section_exit();
+}
+
+void event_flags_cancel(struct event_flags *event_flags, struct event_waiter *waiter)
+{
+    system_critical_section_enter();
+
+    if (waiter->waiting) {
+        remove_locked(event_flags, waiter);
+    }
+
+    system_critical_section_exit();
+}
+
+uint32_t event_waiter_matched(struct work *work)
+{
+    struct event_waiter *waiter = CONTAINER_OF(work, struct event_waiter, work);
+
+    return waiter->matched;
+}
+
+/**
+ * Helper function to submit a waiter if its condition matches.
+ *
+ * Interrupts must be locked.
+ *
+ * @param event_flags Event flags object.
+ * @param waiter Waiter to check.
+ * @return True if the waiter was submitted, false otherwise.
+ */
+static bool_t try_wake_locked(struct event_flags *event_flags, struct event_waiter *waiter)
+{
+    uint32_t matched = event_flags->flags & waiter->mask;
+
+    if ((waiter->options & EVENT_WAIT_ALL) != 0) {
+        if (matched != waiter->mask) {
+            return false;
+        }
+    } else if (matched == 0) {
+        return false;
+    }
+
+    if ((waiter->options & EVENT_WAIT_CLEAR) != 0) {
+        event_flags->flags &= ~matched;
+    }
+
+    waiter->matched = matched;
+    work_submit(&waiter->work);
+
+    return true;
+}
+
+/**
+ * Helper function to remove a waiter from the list of waiters.
+ *
+ * Interrupts must be locked.
+ *
+ * @param event_flags Event flags object.
+ * @param waiter Waiter to remove.
+ */
+static void remove_locked(struct event_flags *event_flags, struct event_waiter *waiter)
+{
+    struct event_waiter **current = &event_flags->waiters;
+
+    while ((*current != NULL) && (*current != waiter)) {
+        current = &(*current)->next;
+    }
+
+    if (*current == waiter) {
+        *current = waiter->next;
+    }
+
+    waiter->next = NULL;
+    waiter->waiting = false;
+}
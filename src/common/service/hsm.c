@@ -0,0 +1,183 @@
+#include <service/hsm.h>
+#include <service/assert.h>
+
+static uint8_t compute_lca(const struct hsm *hsm, const struct hsm_state *source, const struct hsm_state *target);
+static void enter_path(struct hsm *hsm, uint8_t from, const struct hsm_state *target);
+static bool_t is_ancestor(const struct hsm_state *ancestor, const struct hsm_state *state);
+static uint8_t state_index(const struct hsm *hsm, const struct hsm_state *state);
+
+void hsm_init(struct hsm *hsm)
+{
+    RUNTIME_ASSERT(hsm->state_count < HSM_STATE_NONE);
+
+    for (uint8_t source = 0; source < hsm->state_count; source++) {
+        for (uint8_t target = 0; target < hsm->state_count; target++) {
+            hsm->lca[source * hsm->state_count + target] =
+                compute_lca(hsm, &hsm->states[source], &hsm->states[target]);
+        }
+    }
+
+    hsm->current = NULL;
+    hsm->target = NULL;
+
+    enter_path(hsm, HSM_STATE_NONE, hsm->initial);
+}
+
+void hsm_dispatch(struct hsm *hsm, const struct hsm_event *event)
+{
+    const struct hsm_state *state = hsm->current;
+    enum hsm_result result = HSM_UNHANDLED;
+
+    // pass event to ancestors until it is handled
+    while (state != NULL) {
+        if (state->handler != NULL) {
+            result = state->handler(hsm, event);
+        }
+
+        if (result != HSM_UNHANDLED) {
+            break;
+        }
+
+        state = state->parent;
+    }
+
+    if (result != HSM_TRANSITION) {
+        return;
+    }
+
+    const struct hsm_state *target = hsm->target;
+    uint8_t lca = hsm->lca[state_index(hsm, state) * hsm->state_count + state_index(hsm, target)];
+
+    hsm->target = NULL;
+
+    // exit current state up to the LCA
+    const struct hsm_state *exiting = hsm->current;
+
+    while ((exiting != NULL) && (state_index(hsm, exiting) != lca)) {
+        if (exiting->exit != NULL) {
+            exiting->exit(hsm);
+        }
+
+        exiting = exiting->parent;
+    }
+
+    enter_path(hsm, lca, target);
+}
+
+enum hsm_result hsm_transition(struct hsm *hsm, const struct hsm_state *target)
+{
+    hsm->target = target;
+    return HSM_TRANSITION;
+}
+
+bool_t hsm_in_state(const struct hsm *hsm, const struct hsm_state *state)
+{
+    const struct hsm_state *current = hsm->current;
+
+    while (current != NULL) {
+        if (current == state) {
+            return true;
+        }
+
+        current = current->parent;
+    }
+
+    return false;
+}
+
+/**
+ * Computes the state below which a transition exits and enters states.
+ *
+ * @param hsm State machine.
+ * @param source State handling the event.
+ * @param target Target of the transition.
+ * @return Index of the state or `HSM_STATE_NONE` if all states up to the top level are exited.
+ */
+static uint8_t compute_lca(const struct hsm *hsm, const struct hsm_state *source, const struct hsm_state *target)
+{
+    // local transition into a descendant
+    if ((source != target) && is_ancestor(source, target)) {
+        return state_index(hsm, source);
+    }
+
+    // nearest common ancestor, a transition to the target itself or to an ancestor re-enters the target
+    const struct hsm_state *ancestor = source;
+
+    while ((ancestor != NULL) && !is_ancestor(ancestor, target)) {
+        ancestor = ancestor->parent;
+    }
+
+    if (ancestor == target) {
+        ancestor = target->parent;
+    }
+
+    return (ancestor != NULL) ? state_index(hsm, ancestor) : HSM_STATE_NONE;
+}
+
+/**
+ * Enters all states below a state down to the target and then follows the initial states.
+ *
+ * @param hsm State machine.
+ * @param from Index of the state which is already active or `HSM_STATE_NONE`.
+ * @param target State to enter.
+ */
+static void enter_path(struct hsm *hsm, uint8_t from, const struct hsm_state *target)
+{
+    while (target != NULL) {
+        const struct hsm_state *path[HSM_MAX_DEPTH];
+        size_t depth = 0;
+
+        for (const struct hsm_state *state = target; (state != NULL) && (state_index(hsm, state) != from);
+             state = state->parent) {
+            RUNTIME_ASSERT(depth < HSM_MAX_DEPTH);
+            path[depth++] = state;
+        }
+
+        // enter from the outermost state
+        while (depth > 0) {
+            depth--;
+
+            if (path[depth]->entry != NULL) {
+                path[depth]->entry(hsm);
+            }
+        }
+
+        hsm->current = target;
+
+        // drill into initial states
+        from = state_index(hsm, target);
+        target = target->initial;
+    }
+}
+
+/**
+ * Helper function to check if a state is an ancestor of or equal to another state.
+ *
+ * @param ancestor Possible ancestor.
+ * @param state State.
+ * @return True if `ancestor` is `state` or one of its ancestors.
+ */
+static bool_t is_ancestor(const struct hsm_state *ancestor, const struct hsm_state *state)
+{
+    while (state != NULL) {
+        if (state == ancestor) {
+            return true;
+        }
+
+        state = state->parent;
+    }
+
+    return false;
+}
+
+/**
+ * Helper function to get the index of a state.
+ *
+ * @param hsm State machine.
+ * @param state State of the state machine.
+ * @return Index of the state in the array of states.
+ */
+static uint8_t state_index(const struct hsm *hsm, const struct hsm_state *state)
+{
+    return (uint8_t) (state - hsm->states);
+}
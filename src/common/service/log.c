@@ -1,15 +1,43 @@
 #include <service/log.h>
+#include <service/log_backend.h>
 #include <service/system.h>
 #include <service/cbprintf.h>
 #include <service/work.h>
+#include <service/stream_buffer.h>
 #include <service/assert.h>
-#include <util/unused.h>
 #include <string.h>
 #include <stdarg.h>
 
-#define LOG_BUFFER_SIZE          1024
+#define LOG_BUFFER_SIZE_HIGH     256
+#define LOG_BUFFER_SIZE_LOW      1024
 #define LOG_WORK_PRIORITY        10
 #define LOG_MAX_MSG_DATA_SIZE    64
+#define LOG_MAX_OUTPUT_LENGTH    192
+
+#define LOG_MODULE_INDEX_MASK    0x1F
+#define LOG_FLAG_HEXDUMP         0x20
+#define LOG_LEVEL_SHIFT          6
+#define LOG_SYNC_RECORD          0x1F  // module index 31
+#define LOG_SYNC_SHIFT           20    // time between messages is tracked in units of 2^20 us (about 1 s)
+#define LOG_SYNC_INTERVAL        1024  // units after which a sync record is needed, half the range of a delta
+
+#define LOG_FRAME_SYNC           0xA5
+#define LOG_FRAME_MESSAGE        0
+#define LOG_FRAME_DROPPED        1
+#define LOG_FRAME_HEXDUMP        2
+
+#define LOG_HEXDUMP_ROW_LENGTH   16
+#define LOG_HEXDUMP_OFFSET       (sizeof(struct log_message_header) + sizeof(const char *))
+
+// largest message copied from a lane, a log message or a hexdump
+#define LOG_MAX_READ_SIZE        (LOG_HEXDUMP_OFFSET + LOG_HEXDUMP_MAX_LENGTH > LOG_MAX_MSG_DATA_SIZE ? \
+                                  LOG_HEXDUMP_OFFSET + LOG_HEXDUMP_MAX_LENGTH : LOG_MAX_MSG_DATA_SIZE)
+
+#ifdef LOG_BINARY
+#define LOG_BINARY_DEFAULT       true
+#else
+#define LOG_BINARY_DEFAULT       false
+#endif
 
 #ifdef BUILD_FIRMWARE
 #define NEWLINE                  "\r\n"
@@ -22,37 +50,109 @@
 #define ANSI_RESET               "\x1B[0m"
 
 /**
- * Ring buffer for log data.
+ * Header of a log message.
+ *
+ * For each log message a header struct followed by the captured format string (see `cbprintf_capture`)
+ * is put into the log message buffer. The size of both together must not exceed `LOG_MAX_MSG_DATA_SIZE`.
+ *
+ * Only the lower 32 bits of the timestamp are stored. The reader restores the full timestamp by adding their
+ * signed difference to the timestamp of the previous message, so messages may be up to 35 minutes apart.
+ * Before a message following a longer pause, a sync record is put: a header with `LOG_SYNC_RECORD` as module
+ * followed by the upper 32 bits of the timestamp.
  *
- * Putting data moves the head forward. Getting data moves the tail forward.
- * The indices wrap around if the end of the buffer is reached.
- * If head == tail the buffer is empty. One byte must always left free otherwise this becomes ambigous.
+ * Hexdumps are marked by `LOG_FLAG_HEXDUMP`. Their header is followed by the description string pointer and the
+ * raw data, which may exceed `LOG_MAX_MSG_DATA_SIZE`.
+ *
+ * Each lane has its own message buffer and timestamps, so messages of one lane never depend on another lane.
+ * The sequence number is counted across all lanes and orders messages created within the same microsecond.
  */
-struct ring_buffer {
-    uint8_t data[LOG_BUFFER_SIZE]; ///< Actual data.
-    size_t head; ///< Index of the ring buffer head.
-    size_t tail; ///< Index of the ring buffer tail.
-    uint32_t dropped; ///< Number of dropped log messages, because there was not enough space.
-};
+struct log_message_header {
+    uint8_t module_level; ///< Module index (bits 0-4), hexdump flag, log level (bits 6-7), or `LOG_SYNC_RECORD`.
+    uint32_t timestamp; ///< Lower 32 bits of the timestamp when the log message was created.
+    uint16_t sequence; ///< Number of messages created before this one, wrapping.
+} __attribute__((packed));
 
 /**
- * Header of a log message.
+ * Header of a log message in a binary frame.
  *
- * For each log message a header struct followed by the captured format string (see `cbprintf_capture`)
- * is put into the logging ring buffer. The size of both together must not exceed `LOG_MAX_MSG_DATA_SIZE`.
+ * Binary frames carry the full module pointer and timestamp, so the host does not depend on previous frames.
  */
-struct log_message_header {
+struct log_frame_header {
     const struct log_module *module; ///< Module which created this log message.
     u64_us_t timestamp; ///< Timestamp when the log message was created.
     uint8_t level; ///< Log level of this message.
 } __attribute__((packed));
 
+/**
+ * Payload of a dropped frame.
+ */
+struct log_frame_dropped {
+    uint32_t count; ///< Number of messages dropped since the last report.
+    uint8_t lane; ///< Lane of the dropped messages.
+} __attribute__((packed));
+
+/**
+ * Message buffer of a log lane.
+ */
+struct lane {
+    struct stream_buffer *buffer; ///< Message buffer, its overflows are the dropped messages of the lane.
+    enum log_policy policy; ///< Behavior when the message buffer is full.
+    uint32_t last_message_time; ///< Time of the last message put in units of 2^LOG_SYNC_SHIFT us.
+    const char *name; ///< Name of the messages in the lane for reporting dropped messages.
+};
+
+/**
+ * Output of a single log message.
+ */
+struct log_line {
+    struct stream_buffer_region region; ///< Reserved space in the TX buffer of the backend.
+    size_t length; ///< Number of bytes written into the region.
+    bool_t truncated; ///< Output did not fit into the region.
+    bool_t direct; ///< Output is written synchronously using `system_debug_out()`.
+};
+
+// the dropped frames of all lanes and a message or hexdump frame always fit into a line
+BUILD_ASSERT(LOG_MAX_OUTPUT_LENGTH >= (LOG_LANE_COUNT + 1) * 4 + LOG_LANE_COUNT * sizeof(struct log_frame_dropped) +
+             sizeof(struct log_frame_header) + LOG_MAX_MSG_DATA_SIZE - sizeof(struct log_message_header));
+BUILD_ASSERT(LOG_MAX_OUTPUT_LENGTH >= (LOG_LANE_COUNT + 1) * 4 + LOG_LANE_COUNT * sizeof(struct log_frame_dropped) +
+             sizeof(struct log_frame_header) + sizeof(const char *) + LOG_HEXDUMP_MAX_LENGTH);
+
+// the sequence numbers of all messages in the lanes can be compared despite wrapping
+BUILD_ASSERT((LOG_BUFFER_SIZE_HIGH + LOG_BUFFER_SIZE_LOW) / sizeof(struct log_message_header) < INT16_MAX);
+
 static void log_output_handler(struct work *work);
 static bool_t log_process(void);
+static void log_output_prefix(struct log_line *line, const struct log_frame_header *header);
+static void log_output_text(struct log_line *line, const struct log_frame_header *header, const uint8_t *package,
+                            size_t length);
+static bool_t log_output_hexdump(struct log_line *line, struct log_backend_lane *state,
+                                 const struct log_frame_header *header, const struct stream_buffer_region *region);
+static void log_output_binary(struct log_line *line, const struct log_frame_header *header, const uint8_t *package,
+                              size_t length);
+static void log_output_frame(struct log_line *line, uint8_t type, const void *payload, size_t length);
+static const struct log_module *module_get(uint8_t index);
+
+static struct lane *lane_get(enum log_level level);
+static bool_t lane_reserve(struct lane *lane, size_t length, struct stream_buffer_region *region);
+static bool_t lane_put(struct lane *lane, const void *data, size_t length);
+static void lane_consume(struct lane *lane, enum log_lane index);
+
+static struct log_message_header message_header(struct lane *lane, const struct log_module *module,
+                                                enum log_level level, u64_us_t timestamp, bool_t *synced);
+static void message_put_done(struct lane *lane, u64_us_t timestamp);
 
-static void ring_buffer_put(const void *data, size_t length);
-static size_t ring_buffer_get(void *data);
-static uint32_t ring_buffer_read_dropped(void);
+static bool_t backend_process(struct log_backend *backend);
+static void backend_reset(struct log_backend *backend);
+static void backend_report_dropped(struct log_line *line, struct log_backend *backend);
+static bool_t backend_read(struct log_backend *backend, enum log_lane *lane, struct stream_buffer_region *region,
+                           uint8_t *copy);
+static bool_t backend_peek(struct log_backend *backend, enum log_lane *lane, struct stream_buffer_region *region);
+static void backend_panic(struct log_backend *backend);
+static void backend_transmit_next(struct log_backend *backend);
+static void update_level_max(void);
+
+static bool_t line_begin(struct log_line *line, struct log_backend *backend);
+static void line_end(struct log_line *line, struct log_backend *backend);
 
 static const char *log_level_str(enum log_level level);
 static const char *log_level_color(enum log_level level);
@@ -60,7 +160,23 @@ static const char *log_level_color(enum log_level level);
 static void output(char c, void *ctx);
 
 static struct log_module *module_list;
-static struct ring_buffer ring_buffer;
+static uint8_t module_count;
+static bool_t binary_output = LOG_BINARY_DEFAULT;
+
+// used as long as no other backend is registered
+static struct log_backend direct_backend = { NULL, NULL, LOG_LEVEL_DBG, 0, false, { { 0, 0, 0, 0 } }, NULL };
+
+static struct log_backend *backend_list = &direct_backend;
+static enum log_level level_max = LOG_LEVEL_DBG;
+static uint16_t message_sequence;
+
+STREAM_BUFFER_DEFINE(log_buffer_high, LOG_BUFFER_SIZE_HIGH);
+STREAM_BUFFER_DEFINE(log_buffer_low, LOG_BUFFER_SIZE_LOW);
+
+static struct lane lanes[LOG_LANE_COUNT] = {
+    [LOG_LANE_HIGH] = { &log_buffer_high, LOG_POLICY_DROP_NEWEST, 0, "errors and warnings" },
+    [LOG_LANE_LOW] = { &log_buffer_low, LOG_POLICY_DROP_NEWEST, 0, "messages" },
+};
 
 WORK_DEFINE(log_output, LOG_WORK_PRIORITY, log_output_handler);
 
@@ -79,8 +195,81 @@ void log_set_level(const char *module_name, enum log_level level)
     }
 }
 
+void log_set_binary(bool_t enabled)
+{
+    binary_output = enabled;
+}
+
+void log_set_policy(enum log_lane lane, enum log_policy policy)
+{
+    RUNTIME_ASSERT(lane < LOG_LANE_COUNT);
+
+    lanes[lane].policy = policy;
+}
+
+void log_backend_register(struct log_backend *backend)
+{
+    if (backend_list == &direct_backend) {
+        backend_list = NULL;
+    }
+
+    backend->transmitting = 0;
+    backend->panic = false;
+    backend_reset(backend);
+    backend->next = backend_list;
+    backend_list = backend;
+
+    update_level_max();
+}
+
+void log_backend_unregister(struct log_backend *backend)
+{
+    struct log_backend **link = &backend_list;
+
+    while ((*link != NULL) && (*link != backend)) {
+        link = &(*link)->next;
+    }
+
+    RUNTIME_ASSERT(*link != NULL);
+    *link = backend->next;
+
+    if (backend_list == NULL) {
+        backend_reset(&direct_backend);
+        backend_list = &direct_backend;
+    }
+
+    update_level_max();
+}
+
+void log_backend_set_level(struct log_backend *backend, enum log_level level)
+{
+    backend->level = level;
+    update_level_max();
+}
+
+void log_backend_transmit_done(struct log_backend *backend)
+{
+    system_critical_section_enter();
+
+    if (!backend->panic) {
+        stream_buffer_consume(backend->buffer, backend->transmitting);
+        backend->transmitting = 0;
+
+        backend_transmit_next(backend);
+    }
+
+    system_critical_section_exit();
+
+    // there is space in the TX buffer again
+    work_submit(&log_output);
+}
+
 void log_panic()
 {
+    for (struct log_backend *backend = backend_list; backend != NULL; backend = backend->next) {
+        backend_panic(backend);
+    }
+
     while (log_process()) {
         // process all log messages
     }
@@ -88,38 +277,129 @@ void log_panic()
 
 void log_message(const struct log_module *module, enum log_level level, const char *format, ...)
 {
-    // early return if log level not enabled
-    if (level > module->level) {
+    // the module level is checked by the macros, return early if no backend wants the message
+    if (level > level_max) {
         return;
     }
 
-    struct log_message_header header = {
-        .timestamp = system_uptime_get_us(),
-        .level = (uint8_t) level,
-        .module = module,
-    };
+    uint8_t package[LOG_MAX_MSG_DATA_SIZE - sizeof(struct log_message_header)];
+
+    va_list ap;
+    va_start(ap, format);
+
+    size_t package_size = cbvprintf_capture(package, sizeof(package), format, ap);
+
+    va_end(ap);
+
+    log_message_package(module, level, package, package_size);
+}
+
+void log_message_package(const struct log_module *module, enum log_level level, const void *package, size_t length)
+{
+    if (level > level_max) {
+        return;
+    }
+
+    struct lane *lane = lane_get(level);
+    u64_us_t timestamp = system_uptime_get_us();
+    bool_t synced;
+    struct log_message_header header = message_header(lane, module, level, timestamp, &synced);
+
+    // a package which does not fit is dropped like a failed capture, only the header is kept
+    if (length > LOG_MAX_MSG_DATA_SIZE - sizeof(header)) {
+        length = 0;
+    }
 
     uint8_t buffer[LOG_MAX_MSG_DATA_SIZE];
     memcpy(buffer, &header, sizeof(header));
+    memcpy(buffer + sizeof(header), package, length);
 
-    va_list ap;
-    va_start(ap, format);
+    // dropped messages are counted by the buffer, a dropped sync record is repeated with the next message
+    if (lane_put(lane, buffer, length + sizeof(header)) && synced) {
+        message_put_done(lane, timestamp);
+    }
 
-    size_t package_size = cbvprintf_capture(buffer + sizeof(header), sizeof(buffer) - sizeof(header), format, ap);
-    ring_buffer_put(buffer, package_size + sizeof(header));
     work_submit(&log_output);
+}
 
-    va_end(ap);
+void log_hexdump(const struct log_module *module, enum log_level level, const void *data, size_t length,
+                 const char *description)
+{
+    if (level > level_max) {
+        return;
+    }
+
+    if (length > LOG_HEXDUMP_MAX_LENGTH) {
+        length = LOG_HEXDUMP_MAX_LENGTH;
+    }
+
+    struct lane *lane = lane_get(level);
+    u64_us_t timestamp = system_uptime_get_us();
+    bool_t synced;
+    struct log_message_header header = message_header(lane, module, level, timestamp, &synced);
+
+    header.module_level |= LOG_FLAG_HEXDUMP;
+
+    // the data is copied directly into the message buffer
+    struct stream_buffer_region region;
+
+    if (lane_reserve(lane, LOG_HEXDUMP_OFFSET + length, &region)) {
+        stream_buffer_region_write(&region, 0, &header, sizeof(header));
+        stream_buffer_region_write(&region, sizeof(header), &description, sizeof(description));
+        stream_buffer_region_write(&region, LOG_HEXDUMP_OFFSET, data, length);
+        stream_buffer_message_commit(lane->buffer, &region);
+
+        if (synced) {
+            message_put_done(lane, timestamp);
+        }
+    }
+
+    work_submit(&log_output);
+}
+
+bool_t log_ratelimit_take(struct log_ratelimit *limit, uint32_t burst, u32_ms_t interval, uint32_t *suppressed)
+{
+    RUNTIME_ASSERT(burst > 0);
+
+    u64_tick_t increment = SYSTEM_MS_TO_TICKS(interval);
+    bool_t allowed = false;
+
+    system_critical_section_enter();
+
+    u64_tick_t now = system_uptime_get_ticks();
+
+    // the bucket does not fill beyond its capacity while the call site is idle
+    if (limit->full_at < now) {
+        limit->full_at = now;
+    }
+
+    // each message takes one interval, the message is allowed if the bucket is not empty afterwards
+    if (limit->full_at - now <= (u64_tick_t) (burst - 1) * increment) {
+        limit->full_at += increment;
+        *suppressed = limit->suppressed;
+        limit->suppressed = 0;
+        allowed = true;
+    } else {
+        limit->suppressed++;
+    }
+
+    system_critical_section_exit();
+
+    return allowed;
 }
 
 void log_module_register(struct log_module *module)
 {
+    // the highest index is reserved for sync records
+    RUNTIME_ASSERT(module_count < LOG_SYNC_RECORD);
+
+    module->index = module_count++;
     module->next = module_list;
     module_list = module;
 }
 
 /**
- * Work handler which processes one log message from the ring buffer.
+ * Work handler which processes one log message from the message buffer.
  * If a message was processed, the work item is resubmitted until there are no more messages.
  *
  * @param work Work item.
@@ -133,160 +413,750 @@ static void log_output_handler(struct work *work)
 }
 
 /**
- * Processes one log message from the ring buffer.
+ * Processes one log message from the message buffers for each backend.
  *
- * @return True if a message has been processed, false if the ring buffer was empty.
+ * @return True if a message has been processed, false if no backend had a message to process.
  */
 bool_t log_process(void)
 {
-    // print number of dropped messages if any
-    uint32_t dropped = ring_buffer_read_dropped();
+    bool_t processed = false;
+
+    for (struct log_backend *backend = backend_list; backend != NULL; backend = backend->next) {
+        if (backend_process(backend)) {
+            processed = true;
+        }
+    }
 
-    if (dropped > 0) {
-        cbprintf(output, NULL, ANSI_BOLD_RED "--- %u messages dropped ---" ANSI_RESET NEWLINE, (unsigned) dropped);
+    for (size_t i = 0; i < LOG_LANE_COUNT; i++) {
+        lane_consume(&lanes[i], (enum log_lane) i);
     }
 
+    return processed;
+}
+
+/**
+ * Processes the next log message of a backend.
+ *
+ * The message with the oldest timestamp of all lanes is processed, so the output of the lanes is interleaved
+ * in the order the messages were created.
+ *
+ * @param backend Backend.
+ * @return True if a message has been processed, false if there was none or the backend is busy.
+ */
+static bool_t backend_process(struct log_backend *backend)
+{
+    struct log_line line;
+
+    // only format if the backend accepts a full line, it resumes the work item once there is space again
+    if (!line_begin(&line, backend)) {
+        return false;
+    }
+
+    backend_report_dropped(&line, backend);
+
     // process one log message
-    uint8_t buffer[LOG_MAX_MSG_DATA_SIZE];
-    size_t length = ring_buffer_get(buffer);
+    struct stream_buffer_region region;
+    enum log_lane index;
+    uint8_t buffer[LOG_MAX_READ_SIZE];
 
-    if (length < sizeof(struct log_message_header)) {
-        RUNTIME_ASSERT(length == 0);
+    if (!backend_read(backend, &index, &region, buffer)) {
+        line_end(&line, backend);
         return false;
     }
 
+    struct log_backend_lane *state = &backend->lanes[index];
+    size_t length = region.length[0] + region.length[1];
+
+    RUNTIME_ASSERT(length >= sizeof(struct log_message_header));
+
     struct log_message_header header;
-    memcpy(&header, buffer, sizeof(header));
+    stream_buffer_region_read(&region, 0, &header, sizeof(header));
+
+    // restore the full timestamp from the delta to the previous message
+    int32_t delta = (int32_t) (header.timestamp - (uint32_t) state->timestamp);
+    state->timestamp += delta;
+
+    if (header.module_level == LOG_SYNC_RECORD) {
+        uint32_t timestamp_high;
+        stream_buffer_region_read(&region, sizeof(header), &timestamp_high, sizeof(timestamp_high));
+
+        state->timestamp = ((u64_us_t) timestamp_high << 32) | header.timestamp;
+        state->position = stream_buffer_message_next(&region);
+        line_end(&line, backend);
+        return true;
+    }
+
+    struct log_frame_header message = {
+        .module = module_get(header.module_level & LOG_MODULE_INDEX_MASK),
+        .timestamp = state->timestamp,
+        .level = (uint8_t) (header.module_level >> LOG_LEVEL_SHIFT),
+    };
+
+    bool_t wanted = (message.level <= backend->level);
+    bool_t done = true;
+
+    // messages only wanted by other backends are skipped
+    if (wanted && ((header.module_level & LOG_FLAG_HEXDUMP) != 0)) {
+        done = log_output_hexdump(&line, state, &message, &region);
+    } else if (wanted) {
+        RUNTIME_ASSERT(length <= LOG_MAX_MSG_DATA_SIZE);
+
+        // a message wrapping around the end of the buffer is formatted from a copy
+        const uint8_t *data = region.data[0];
+
+        if (region.length[1] > 0) {
+            stream_buffer_region_copy_out(&region, buffer);
+            data = buffer;
+        }
+
+        if (binary_output) {
+            log_output_binary(&line, &message, data + sizeof(header), length - sizeof(header));
+        } else {
+            log_output_text(&line, &message, data + sizeof(header), length - sizeof(header));
+        }
+    }
+
+    // hexdumps stay at the current message until all lines are output
+    if (done) {
+        state->position = stream_buffer_message_next(&region);
+    }
+
+    line_end(&line, backend);
+    return true;
+}
+
+/**
+ * Starts a backend at the oldest messages which have not been freed yet.
+ *
+ * @param backend Backend.
+ */
+static void backend_reset(struct log_backend *backend)
+{
+    for (size_t i = 0; i < LOG_LANE_COUNT; i++) {
+        struct log_backend_lane *state = &backend->lanes[i];
+
+        state->position = lanes[i].buffer->read;
+        state->dropped_reported = __atomic_load_n(&lanes[i].buffer->overflows, __ATOMIC_RELAXED);
+        state->timestamp = system_uptime_get_us();
+        state->hexdump_row = 0;
+    }
+}
+
+/**
+ * Outputs the number of messages dropped in each lane since the last report of a backend.
+ *
+ * @param line Output of the report.
+ * @param backend Backend.
+ */
+static void backend_report_dropped(struct log_line *line, struct log_backend *backend)
+{
+    for (size_t i = 0; i < LOG_LANE_COUNT; i++) {
+        struct log_backend_lane *state = &backend->lanes[i];
+        uint32_t overflows = __atomic_load_n(&lanes[i].buffer->overflows, __ATOMIC_RELAXED);
+        struct log_frame_dropped dropped = { overflows - state->dropped_reported, (uint8_t) i };
+
+        state->dropped_reported = overflows;
+
+        if ((dropped.count > 0) && binary_output) {
+            log_output_frame(line, LOG_FRAME_DROPPED, &dropped, sizeof(dropped));
+        } else if (dropped.count > 0) {
+            cbprintf(output, line, ANSI_BOLD_RED "--- %u %s dropped ---" ANSI_RESET NEWLINE,
+                     (unsigned) dropped.count, lanes[i].name);
+        }
+    }
+}
+
+/**
+ * Finds the next message of a backend and makes sure that it can be read until the backend is done with it.
+ *
+ * A producer of an overwriting lane may free its oldest messages as soon as interrupts are unlocked. If any lane
+ * overwrites, the message is therefore found with interrupts locked, and copied if it belongs to such a lane.
+ * Messages of the other lanes are only freed once all backends processed them, so they are read in place.
+ *
+ * @param backend Backend.
+ * @param lane Set to the lane of the message.
+ * @param region Set to the region of the message in the message buffer or in the copy.
+ * @param copy Buffer of `LOG_MAX_READ_SIZE` bytes for the copy.
+ * @return True if a message was found, false if all lanes are empty for this backend.
+ */
+static bool_t backend_read(struct log_backend *backend, enum log_lane *lane, struct stream_buffer_region *region,
+                           uint8_t *copy)
+{
+    bool_t overwriting = false;
+
+    for (size_t i = 0; i < LOG_LANE_COUNT; i++) {
+        if (lanes[i].policy == LOG_POLICY_OVERWRITE_OLDEST) {
+            overwriting = true;
+        }
+    }
+
+    if (!overwriting) {
+        return backend_peek(backend, lane, region);
+    }
+
+    system_critical_section_enter();
+
+    bool_t found = backend_peek(backend, lane, region);
+
+    if (found && (lanes[*lane].policy == LOG_POLICY_OVERWRITE_OLDEST)) {
+        size_t length = region->length[0] + region->length[1];
+
+        RUNTIME_ASSERT(length <= LOG_MAX_READ_SIZE);
+        stream_buffer_region_copy_out(region, copy);
+
+        region->data[0] = copy;
+        region->length[0] = length;
+        region->data[1] = NULL;
+        region->length[1] = 0;
+    }
+
+    system_critical_section_exit();
+
+    return found;
+}
+
+/**
+ * Finds the next message of a backend in all lanes.
+ *
+ * An unfinished hexdump is continued first, then sync records are taken, as they do not create output and are
+ * needed to restore the timestamp of the following message. Otherwise the message with the oldest timestamp is
+ * taken, on equal timestamps the one which was created first.
+ *
+ * Interrupts must be locked if a lane overwrites its oldest messages.
+ *
+ * @param backend Backend.
+ * @param lane Set to the lane of the message.
+ * @param region Set to the region of the message.
+ * @return True if a message was found, false if all lanes are empty for this backend.
+ */
+static bool_t backend_peek(struct log_backend *backend, enum log_lane *lane, struct stream_buffer_region *region)
+{
+    bool_t found = false;
+    u64_us_t oldest = 0;
+    uint16_t oldest_sequence = 0;
+
+    for (size_t i = 0; i < LOG_LANE_COUNT; i++) {
+        struct log_backend_lane *state = &backend->lanes[i];
+        struct stream_buffer *buffer = lanes[i].buffer;
+        struct stream_buffer_region candidate;
+
+        // messages overwritten before this backend read them are skipped, the delta to them is lost
+        if ((int32_t) (state->position - buffer->read) < 0) {
+            state->position = buffer->read;
+            state->timestamp = system_uptime_get_us();
+            state->hexdump_row = 0;
+        }
+
+        if (!stream_buffer_message_peek_at(buffer, state->position, &candidate)) {
+            continue;
+        }
+
+        struct log_message_header header;
+        stream_buffer_region_read(&candidate, 0, &header, sizeof(header));
+
+        if ((state->hexdump_row > 0) || (header.module_level == LOG_SYNC_RECORD)) {
+            *lane = (enum log_lane) i;
+            *region = candidate;
+            return true;
+        }
+
+        u64_us_t timestamp = state->timestamp + (int32_t) (header.timestamp - (uint32_t) state->timestamp);
+
+        if (!found || (timestamp < oldest) ||
+            ((timestamp == oldest) && ((int16_t) (header.sequence - oldest_sequence) < 0))) {
+            found = true;
+            oldest = timestamp;
+            oldest_sequence = header.sequence;
+            *lane = (enum log_lane) i;
+            *region = candidate;
+        }
+    }
 
-    uint32_t timestamp_s = header.timestamp / 1000000ULL;
-    uint32_t timestamp_us = header.timestamp % 1000000ULL;
+    return found;
+}
+
+/**
+ * Stops asynchronous output of a backend and writes its pending output synchronously.
+ *
+ * @param backend Backend.
+ */
+static void backend_panic(struct log_backend *backend)
+{
+    if ((backend->api == NULL) || backend->panic) {
+        return;
+    }
+
+    system_critical_section_enter();
+
+    backend->panic = true;
+    size_t transmitting = backend->transmitting;
+
+    system_critical_section_exit();
+
+    if (transmitting > 0) {
+        stream_buffer_consume(backend->buffer, backend->api->panic(backend));
+    }
+
+    // write what is left in the TX buffer synchronously
+    struct stream_buffer_region region;
+    size_t length = stream_buffer_peek(backend->buffer, &region);
+
+    for (size_t i = 0; i < 2; i++) {
+        for (size_t j = 0; j < region.length[i]; j++) {
+            system_debug_out((char) region.data[i][j]);
+        }
+    }
+
+    stream_buffer_consume(backend->buffer, length);
+}
+
+/**
+ * Updates the most verbose level wanted by any backend.
+ */
+static void update_level_max(void)
+{
+    enum log_level level = LOG_LEVEL_ERR;
+
+    for (struct log_backend *backend = backend_list; backend != NULL; backend = backend->next) {
+        if (backend->level > level) {
+            level = backend->level;
+        }
+    }
+
+    level_max = level;
+}
+
+/**
+ * Formats the prefix of a log message as text.
+ *
+ * @param line Output of the message.
+ * @param header Decoded header of the message.
+ */
+static void log_output_prefix(struct log_line *line, const struct log_frame_header *header)
+{
+    uint32_t timestamp_s = header->timestamp / 1000000ULL;
+    uint32_t timestamp_us = header->timestamp % 1000000ULL;
 
     cbprintf(
         output,
-        NULL,
+        line,
         "[%02u:%02u:%02u.%03u,%03u] %s<%s> %s: ",
         (unsigned) (timestamp_s / 3600),
         (unsigned) (timestamp_s / 60 % 60),
         (unsigned) (timestamp_s % 60),
         (unsigned) (timestamp_us / 1000),
         (unsigned) (timestamp_us % 1000),
-        log_level_color((enum log_level) header.level),
-        log_level_str((enum log_level) header.level),
-        header.module->name
+        log_level_color((enum log_level) header->level),
+        log_level_str((enum log_level) header->level),
+        header->module->name
     );
+}
+
+/**
+ * Formats a log message as text.
+ *
+ * @param line Output of the message.
+ * @param header Decoded header of the message.
+ * @param package Captured format string.
+ * @param length Length of the captured format string in bytes.
+ */
+static void log_output_text(struct log_line *line, const struct log_frame_header *header, const uint8_t *package,
+                            size_t length)
+{
+    log_output_prefix(line, header);
 
     cbprintf_restore(
         output,
-        NULL,
-        buffer + sizeof(header),
-        length - sizeof(header)
+        line,
+        package,
+        length
     );
 
     cbprintf(
         output,
-        NULL,
+        line,
         ANSI_RESET NEWLINE
     );
-
-    return true;
 }
 
 /**
- * Write log message data into the ring buffer.
+ * Outputs the next line of a hexdump.
  *
- * The log message data must not be larger than `LOG_MAX_MSG_DATA_SIZE`.
- * If there is not enough space in the ring buffer, a dropped counter is incremented and the data is discarded.
+ * In text mode, the first line contains the description, each further line up to 16 bytes with their offset,
+ * hex values and ASCII characters. In binary mode, the whole hexdump is sent in a single frame.
  *
- * @param data Data to put.
- * @param length Length in bytes.
+ * @param line Output of the line.
+ * @param state Read state of the backend in the lane of the hexdump, tracks the next line.
+ * @param header Decoded header of the message.
+ * @param region Region of the hexdump message.
+ * @return True if the hexdump is complete, false if there are more lines.
  */
-static void ring_buffer_put(const void *data, size_t length)
+static bool_t log_output_hexdump(struct log_line *line, struct log_backend_lane *state,
+                                 const struct log_frame_header *header, const struct stream_buffer_region *region)
 {
-    RUNTIME_ASSERT(length <= LOG_MAX_MSG_DATA_SIZE);
+    size_t length = region->length[0] + region->length[1] - LOG_HEXDUMP_OFFSET;
+    const char *description;
 
-    system_critical_section_enter();
+    RUNTIME_ASSERT(length <= LOG_HEXDUMP_MAX_LENGTH);
+
+    stream_buffer_region_read(region, sizeof(struct log_message_header), &description, sizeof(description));
+
+    if (binary_output) {
+        uint8_t payload[sizeof(struct log_frame_header) + sizeof(description) + LOG_HEXDUMP_MAX_LENGTH];
 
-    // check if enough space is available
-    size_t buffer_free = 0;
+        memcpy(payload, header, sizeof(*header));
+        memcpy(payload + sizeof(*header), &description, sizeof(description));
+        stream_buffer_region_read(region, LOG_HEXDUMP_OFFSET, payload + sizeof(*header) + sizeof(description),
+                                  length);
 
-    if (ring_buffer.tail > ring_buffer.head) {
-        buffer_free = ring_buffer.tail - ring_buffer.head;
+        log_output_frame(line, LOG_FRAME_HEXDUMP, payload, sizeof(*header) + sizeof(description) + length);
+        return true;
+    }
+
+    size_t row = state->hexdump_row;
+
+    if (row == 0) {
+        log_output_prefix(line, header);
+        cbprintf(output, line, "%s" ANSI_RESET NEWLINE, description);
     } else {
-        buffer_free = LOG_BUFFER_SIZE - (ring_buffer.head - ring_buffer.tail);
+        uint8_t data[LOG_HEXDUMP_ROW_LENGTH];
+        size_t offset = (row - 1) * LOG_HEXDUMP_ROW_LENGTH;
+        size_t count = length - offset < LOG_HEXDUMP_ROW_LENGTH ? length - offset : LOG_HEXDUMP_ROW_LENGTH;
+
+        stream_buffer_region_read(region, LOG_HEXDUMP_OFFSET + offset, data, count);
+
+        cbprintf(output, line, "    %04x: ", (unsigned) offset);
+
+        for (size_t i = 0; i < LOG_HEXDUMP_ROW_LENGTH; i++) {
+            if (i < count) {
+                cbprintf(output, line, "%02x ", (unsigned) data[i]);
+            } else {
+                cbprintf(output, line, "   ");
+            }
+        }
+
+        output(' ', line);
+        output('|', line);
+
+        for (size_t i = 0; i < count; i++) {
+            output(((data[i] >= ' ') && (data[i] <= '~')) ? (char) data[i] : '.', line);
+        }
+
+        cbprintf(output, line, "|" NEWLINE);
     }
 
-    // 1 extra byte for data size
-    // 1 extra byte to not have an ambiguous situation if head == tail
-    if (length + 2 > buffer_free) {
-        ring_buffer.dropped++;
-        system_critical_section_exit();
-        return;
+    if (row * LOG_HEXDUMP_ROW_LENGTH >= length) {
+        state->hexdump_row = 0;
+        return true;
     }
 
-    // write data size byte
-    ring_buffer.data[ring_buffer.head] = (uint8_t) length;
-    ring_buffer.head = (ring_buffer.head + 1) % LOG_BUFFER_SIZE;
+    state->hexdump_row++;
+    return false;
+}
+
+/**
+ * Outputs a log message as binary frame.
+ *
+ * The package is sent as it is, the host resolves all pointers using the ELF file.
+ *
+ * @param line Output of the message.
+ * @param header Decoded header of the message.
+ * @param package Captured format string.
+ * @param length Length of the captured format string in bytes.
+ */
+static void log_output_binary(struct log_line *line, const struct log_frame_header *header, const uint8_t *package,
+                              size_t length)
+{
+    uint8_t payload[sizeof(struct log_frame_header) + LOG_MAX_MSG_DATA_SIZE - sizeof(struct log_message_header)];
+
+    memcpy(payload, header, sizeof(*header));
+    memcpy(payload + sizeof(*header), package, length);
+
+    log_output_frame(line, LOG_FRAME_MESSAGE, payload, sizeof(*header) + length);
+}
+
+/**
+ * Outputs a binary frame.
+ *
+ * A frame consists of a sync byte, the frame type, the payload length, the payload and an XOR checksum over
+ * type, length and payload.
+ *
+ * @param line Output of the message.
+ * @param type Frame type.
+ * @param payload Payload of the frame.
+ * @param length Length of the payload in bytes, at most 255.
+ */
+static void log_output_frame(struct log_line *line, uint8_t type, const void *payload, size_t length)
+{
+    const uint8_t *data = payload;
+    uint8_t checksum = type ^ (uint8_t) length;
+
+    RUNTIME_ASSERT(length <= UINT8_MAX);
+
+    output((char) LOG_FRAME_SYNC, line);
+    output((char) type, line);
+    output((char) length, line);
 
-    // write data bytes
     for (size_t i = 0; i < length; i++) {
-        ring_buffer.data[ring_buffer.head] = ((const uint8_t *) data)[i];
-        ring_buffer.head = (ring_buffer.head + 1) % LOG_BUFFER_SIZE;
+        output((char) data[i], line);
+        checksum ^= data[i];
     }
 
-    system_critical_section_exit();
+    output((char) checksum, line);
+}
+
+/**
+ * Looks up a module by its index in log messages.
+ *
+ * @param index Index of the module.
+ * @return Module.
+ */
+static const struct log_module *module_get(uint8_t index)
+{
+    const struct log_module *module = module_list;
+
+    while ((module != NULL) && (module->index != index)) {
+        module = module->next;
+    }
+
+    RUNTIME_ASSERT(module != NULL);
+    return module;
+}
+
+/**
+ * Gets the lane of log messages with the given level.
+ *
+ * @param level Log level.
+ * @return Lane.
+ */
+static struct lane *lane_get(enum log_level level)
+{
+    return &lanes[(level <= LOG_LEVEL_WRN) ? LOG_LANE_HIGH : LOG_LANE_LOW];
 }
 
 /**
- * Read log message data from the ring buffer.
+ * Reserves space for a new message in a lane.
+ *
+ * If the message buffer is full and the lane overwrites its oldest messages, they are freed until the new message
+ * fits. Each failed reservation is counted as overflow by the buffer, so the count matches the freed messages plus
+ * the new message if it still does not fit. Messages which are not committed yet cannot be freed.
  *
- * @param data Buffer to store the read log message data. Must be at least `LOG_MAX_MSG_DATA_SIZE` in size.
- * @return Length of the retrieved message in bytes or 0 if the buffer was empty.
+ * @param lane Lane.
+ * @param length Length of the message in bytes.
+ * @param region Set to the region of the message.
+ * @return True if the space is reserved, false if the message is dropped.
  */
-static size_t ring_buffer_get(void *data)
+static bool_t lane_reserve(struct lane *lane, size_t length, struct stream_buffer_region *region)
 {
+    if (stream_buffer_message_reserve(lane->buffer, length, region)) {
+        return true;
+    }
+
+    if (lane->policy != LOG_POLICY_OVERWRITE_OLDEST) {
+        return false;
+    }
+
+    bool_t reserved = false;
+    struct stream_buffer_region oldest;
+
+    // the log work item and other producers only free messages with interrupts locked as well
     system_critical_section_enter();
 
-    // check if data is available
-    if (ring_buffer.head == ring_buffer.tail) {
-        system_critical_section_exit();
-        return 0;
+    while (!reserved && stream_buffer_message_peek(lane->buffer, &oldest)) {
+        stream_buffer_message_consume_to(lane->buffer, stream_buffer_message_next(&oldest));
+        reserved = stream_buffer_message_reserve(lane->buffer, length, region);
     }
 
-    // read data size byte
-    uint8_t length = ring_buffer.data[ring_buffer.tail];
-    ring_buffer.tail = (ring_buffer.tail + 1) % LOG_BUFFER_SIZE;
+    system_critical_section_exit();
 
-    // read data bytes
-    for (size_t i = 0; i < length; i++) {
-        if (ring_buffer.head == ring_buffer.tail) {
-            // inconsistency between the read data size byte and the data available in the buffer
-            system_critical_section_exit();
-            RUNTIME_ASSERT(false);
-            return 0;
+    return reserved;
+}
+
+/**
+ * Puts a new message into a lane.
+ *
+ * @param lane Lane.
+ * @param data Message.
+ * @param length Length of the message in bytes.
+ * @return True if the message was put, false if it was dropped.
+ */
+static bool_t lane_put(struct lane *lane, const void *data, size_t length)
+{
+    struct stream_buffer_region region;
+
+    if (!lane_reserve(lane, length, &region)) {
+        return false;
+    }
+
+    stream_buffer_region_copy_in(&region, data);
+    stream_buffer_message_commit(lane->buffer, &region);
+
+    return true;
+}
+
+/**
+ * Frees the messages of a lane which all backends have processed.
+ *
+ * @param lane Lane.
+ * @param index Index of the lane in the read state of the backends.
+ */
+static void lane_consume(struct lane *lane, enum log_lane index)
+{
+    // only producers of an overwriting lane free messages as well
+    bool_t overwriting = (lane->policy == LOG_POLICY_OVERWRITE_OLDEST);
+
+    if (overwriting) {
+        system_critical_section_enter();
+    }
+
+    uint32_t read = lane->buffer->read;
+    uint32_t consumed = UINT32_MAX;
+
+    for (struct log_backend *backend = backend_list; backend != NULL; backend = backend->next) {
+        uint32_t position = backend->lanes[index].position;
+
+        // a backend behind the read position lost messages to an overwriting producer and frees nothing
+        uint32_t processed = ((int32_t) (position - read) > 0) ? position - read : 0;
+
+        if (processed < consumed) {
+            consumed = processed;
         }
+    }
 
-        ((uint8_t *) data)[i] = ring_buffer.data[ring_buffer.tail];
-        ring_buffer.tail = (ring_buffer.tail + 1) % LOG_BUFFER_SIZE;
+    if ((consumed > 0) && (consumed != UINT32_MAX)) {
+        stream_buffer_message_consume_to(lane->buffer, read + consumed);
     }
 
-    system_critical_section_exit();
-    return length;
+    if (overwriting) {
+        system_critical_section_exit();
+    }
 }
 
 /**
- * Reads and resets the dropped message counter.
+ * Creates the header of a new log message.
+ *
+ * Puts a sync record first if the previous message of the lane may be too long ago for the reader to restore the
+ * full timestamp from the delta.
  *
- * @return Counter value.
+ * @param lane Lane of the message.
+ * @param module Module sending the log message.
+ * @param level Log level of the message.
+ * @param timestamp Timestamp of the message.
+ * @param synced Set to false if a needed sync record was dropped.
+ * @return Header of the message.
  */
-static uint32_t ring_buffer_read_dropped(void)
+static struct log_message_header message_header(struct lane *lane, const struct log_module *module,
+                                                enum log_level level, u64_us_t timestamp, bool_t *synced)
 {
-    system_critical_section_enter();
+    uint32_t time = (uint32_t) (timestamp >> LOG_SYNC_SHIFT);
+
+    *synced = true;
+
+    if (time - __atomic_load_n(&lane->last_message_time, __ATOMIC_RELAXED) >= LOG_SYNC_INTERVAL) {
+        uint8_t record[sizeof(struct log_message_header) + sizeof(uint32_t)];
+        struct log_message_header sync = { LOG_SYNC_RECORD, (uint32_t) timestamp, 0 };
+        uint32_t timestamp_high = (uint32_t) (timestamp >> 32);
+
+        memcpy(record, &sync, sizeof(sync));
+        memcpy(record + sizeof(sync), &timestamp_high, sizeof(timestamp_high));
+
+        *synced = lane_put(lane, record, sizeof(record));
+    }
+
+    struct log_message_header header = {
+        .module_level = (uint8_t) (module->index | (level << LOG_LEVEL_SHIFT)),
+        .timestamp = (uint32_t) timestamp,
+        .sequence = __atomic_fetch_add(&message_sequence, 1, __ATOMIC_RELAXED),
+    };
+
+    return header;
+}
 
-    uint32_t ret = ring_buffer.dropped;
-    ring_buffer.dropped = 0;
+/**
+ * Records the time of a message which has been put together with any needed sync record.
+ *
+ * @param lane Lane of the message.
+ * @param timestamp Timestamp of the message.
+ */
+static void message_put_done(struct lane *lane, u64_us_t timestamp)
+{
+    __atomic_store_n(&lane->last_message_time, (uint32_t) (timestamp >> LOG_SYNC_SHIFT), __ATOMIC_RELAXED);
+}
+
+/**
+ * Prepares the output of a log message.
+ *
+ * @param line Output to prepare.
+ * @param backend Backend receiving the output.
+ * @return True if the output can be written, false if the TX buffer of the backend is too full.
+ */
+static bool_t line_begin(struct log_line *line, struct log_backend *backend)
+{
+    line->length = 0;
+    line->truncated = false;
+    line->direct = (backend->api == NULL) || backend->panic;
+
+    if (line->direct) {
+        return true;
+    }
+
+    size_t reserved = stream_buffer_reserve(backend->buffer, LOG_MAX_OUTPUT_LENGTH, &line->region);
+
+    return reserved == LOG_MAX_OUTPUT_LENGTH;
+}
+
+/**
+ * Hands the output of a log message to the backend.
+ *
+ * @param line Output prepared by `line_begin()`.
+ * @param backend Backend receiving the output.
+ */
+static void line_end(struct log_line *line, struct log_backend *backend)
+{
+    if (line->direct) {
+        return;
+    }
+
+    if (line->truncated) {
+        // terminate the cut off text line
+        static const char terminator[] = ANSI_RESET NEWLINE;
+
+        line->length -= sizeof(terminator) - 1;
+
+        for (size_t i = 0; i < sizeof(terminator) - 1; i++) {
+            output(terminator[i], line);
+        }
+    }
 
+    stream_buffer_commit(backend->buffer, line->length);
+
+    system_critical_section_enter();
+    backend_transmit_next(backend);
     system_critical_section_exit();
-    return ret;
+}
+
+/**
+ * Starts transmitting the next chunk of the TX buffer if the backend is idle.
+ *
+ * Must be called with interrupts locked.
+ *
+ * @param backend Backend.
+ */
+static void backend_transmit_next(struct log_backend *backend)
+{
+    if (backend->panic || (backend->transmitting > 0)) {
+        return;
+    }
+
+    struct stream_buffer_region region;
+
+    if (stream_buffer_peek(backend->buffer, &region) == 0) {
+        return;
+    }
+
+    // chunks are contiguous, a wrapped region is transmitted in two chunks
+    backend->transmitting = region.length[0];
+    backend->api->transmit(backend, region.data[0], region.length[0]);
 }
 
 /**
@@ -324,13 +1194,30 @@ static const char *log_level_color(enum log_level level)
 }
 
 /**
- * Helper function compatible with cbprintf to print to the debug output.
+ * Helper function compatible with cbprintf to print to the TX buffer of the backend or the debug output.
  *
  * @param c Character to print.
- * @param ctx User context (unused).
+ * @param ctx Output of the current message, see `struct log_line`.
  */
 void output(char c, void *ctx)
 {
-    ARG_UNUSED(ctx);
-    system_debug_out(c);
+    struct log_line *line = ctx;
+
+    if (line->direct) {
+        system_debug_out(c);
+        return;
+    }
+
+    if (line->length >= line->region.length[0] + line->region.length[1]) {
+        line->truncated = true;
+        return;
+    }
+
+    if (line->length < line->region.length[0]) {
+        line->region.data[0][line->length] = (uint8_t) c;
+    } else {
+        line->region.data[1][line->length - line->region.length[0]] = (uint8_t) c;
+    }
+
+    line->length++;
 }
@@ -0,0 +1,186 @@
+#include <service/pipeline.h>
+#include <service/system.h>
+#include <service/assert.h>
+#include <util/container_of.h>
+#include <string.h>
+
+static void commit_locked(struct pipeline_stage *stage, size_t length);
+static void release_locked(struct pipeline_stage *stage);
+
+void pipeline_connect(struct pipeline_stage *upstream, struct pipeline_stage *downstream)
+{
+    RUNTIME_ASSERT(upstream->buffer_size > 0);
+    RUNTIME_ASSERT(downstream->process != NULL);
+
+    upstream->downstream = downstream;
+    downstream->upstream = upstream;
+}
+
+void *pipeline_acquire(struct pipeline_stage *stage)
+{
+    void *buffer = NULL;
+
+    system_critical_section_enter();
+
+    if (stage->full_count < 2) {
+        buffer = stage->buffers[stage->write_index];
+    } else {
+        stage->stats.stalls++;
+    }
+
+    system_critical_section_exit();
+
+    return buffer;
+}
+
+void pipeline_commit(struct pipeline_stage *stage, size_t length)
+{
+    system_critical_section_enter();
+
+    commit_locked(stage, length);
+
+    // processing stages count their input blocks instead
+    if (stage->process == NULL) {
+        stage->stats.blocks++;
+        stage->stats.bytes += length;
+    }
+
+    system_critical_section_exit();
+}
+
+const void *pipeline_peek(struct pipeline_stage *stage, size_t *length)
+{
+    const void *block = NULL;
+
+    system_critical_section_enter();
+
+    if (stage->full_count > 0) {
+        block = stage->buffers[stage->read_index];
+        *length = stage->lengths[stage->read_index];
+    }
+
+    system_critical_section_exit();
+
+    return block;
+}
+
+void pipeline_release(struct pipeline_stage *stage)
+{
+    system_critical_section_enter();
+    release_locked(stage);
+    system_critical_section_exit();
+}
+
+bool_t pipeline_stage_process(struct pipeline_stage *stage)
+{
+    struct pipeline_stage *upstream = stage->upstream;
+
+    system_critical_section_enter();
+
+    if ((upstream == NULL) || (upstream->full_count == 0)) {
+        system_critical_section_exit();
+        return false;
+    }
+
+    // keep the block in the upstream buffer until an output buffer is free
+    if ((stage->buffer_size > 0) && (stage->full_count == 2)) {
+        stage->stats.stalls++;
+        system_critical_section_exit();
+        return false;
+    }
+
+    const void *input = upstream->buffers[upstream->read_index];
+    size_t length = upstream->lengths[upstream->read_index];
+    void *output = (stage->buffer_size > 0) ? stage->buffers[stage->write_index] : NULL;
+
+    system_critical_section_exit();
+
+    // process in place, the buffers are owned by this stage until committed or released
+    size_t output_length = stage->process(stage, input, length, output);
+    RUNTIME_ASSERT(output_length <= stage->buffer_size);
+
+    system_critical_section_enter();
+
+    if (output_length > 0) {
+        commit_locked(stage, output_length);
+    }
+
+    release_locked(upstream);
+
+    stage->stats.blocks++;
+    stage->stats.bytes += length;
+
+    system_critical_section_exit();
+
+    return true;
+}
+
+void pipeline_stats_read(struct pipeline_stage *stage, struct pipeline_stats *stats)
+{
+    u64_us_t now = system_uptime_get_us();
+
+    system_critical_section_enter();
+
+    *stats = stage->stats;
+    memset(&stage->stats, 0, sizeof(stage->stats));
+    stage->stats.since = now;
+
+    system_critical_section_exit();
+}
+
+uint32_t pipeline_stats_byte_rate(const struct pipeline_stats *stats, u64_us_t now)
+{
+    u64_us_t duration = now - stats->since;
+
+    if (duration == 0) {
+        return 0;
+    }
+
+    return (uint32_t) (((u64_us_t) stats->bytes * 1000000) / duration);
+}
+
+void pipeline_stage_handler(struct work *work)
+{
+    struct pipeline_stage *stage = CONTAINER_OF(work, struct pipeline_stage, work);
+
+    if (pipeline_stage_process(stage)) {
+        // resubmit work until there are no more input blocks
+        work_submit(work);
+    }
+}
+
+/**
+ * Marks the buffer at the write index as committed and submits the downstream stage.
+ *
+ * @param stage Stage.
+ * @param length Length of the block in bytes.
+ */
+static void commit_locked(struct pipeline_stage *stage, size_t length)
+{
+    RUNTIME_ASSERT(stage->full_count < 2);
+
+    stage->lengths[stage->write_index] = length;
+    stage->write_index ^= 1;
+    stage->full_count++;
+
+    if (stage->downstream != NULL) {
+        work_submit(&stage->downstream->work);
+    }
+}
+
+/**
+ * Frees the buffer at the read index and submits the stage, which might have been stalled.
+ *
+ * @param stage Stage.
+ */
+static void release_locked(struct pipeline_stage *stage)
+{
+    RUNTIME_ASSERT(stage->full_count > 0);
+
+    stage->read_index ^= 1;
+    stage->full_count--;
+
+    if (stage->process != NULL) {
+        work_submit(&stage->work);
+    }
+}
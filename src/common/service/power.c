@@ -0,0 +1,153 @@
+#include <service/power.h>
+#include <service/system.h>
+#include <service/assert.h>
+#include <util/unused.h>
+
+#define POWER_HISTORY_SIZE        8
+#define POWER_HISTORY_MAX_TIME    (UINT32_MAX / POWER_HISTORY_SIZE)  // sum of all records fits into 32 bit
+
+/**
+ * Outcome of a past sleep period as recorded by the menu governor.
+ */
+struct wakeup_record {
+    u32_us_t measured_time; ///< Time spent sleeping, limited to `POWER_HISTORY_MAX_TIME`.
+    bool_t early; ///< True if the wake-up happened before the scheduled time.
+};
+
+static void menu_reset(void);
+static size_t menu_select(const struct system_sleep_state *states, size_t count, u64_us_t idle_time);
+static void menu_reflect(size_t state, u64_us_t idle_time, u64_us_t measured_time);
+
+static u32_us_t limit_time(u64_us_t value);
+
+const struct power_governor power_governor_menu = {
+    .reset = menu_reset,
+    .select = menu_select,
+    .reflect = menu_reflect,
+};
+
+static const struct power_governor *governor = &power_governor_menu;
+
+static struct wakeup_record history[POWER_HISTORY_SIZE];
+static size_t history_index;
+static size_t history_count;
+
+void power_governor_set(const struct power_governor *new_governor)
+{
+    RUNTIME_ASSERT(new_governor != NULL);
+
+    governor = new_governor;
+
+    if (governor->reset != NULL) {
+        governor->reset();
+    }
+}
+
+size_t power_select(u64_us_t idle_time)
+{
+    const struct system_sleep_state *states = NULL;
+    size_t count = system_sleep_states_get(&states);
+
+    RUNTIME_ASSERT(count > 0);
+
+    size_t state = governor->select(states, count, idle_time);
+
+    // never trust the governor to return a valid index
+    if (state >= count) {
+        state = 0;
+    }
+
+    return state;
+}
+
+void power_sleep(u64_us_t idle_time)
+{
+    size_t state = power_select(idle_time);
+
+    u64_us_t sleep_start = system_uptime_get_us();
+    system_enter_sleep_mode(state);
+    u64_us_t sleep_end = system_uptime_get_us();
+
+    if (governor->reflect != NULL) {
+        governor->reflect(state, idle_time, sleep_end - sleep_start);
+    }
+}
+
+/**
+ * Clears the wake-up history of the menu governor.
+ */
+static void menu_reset(void)
+{
+    history_index = 0;
+    history_count = 0;
+}
+
+/**
+ * Selects the deepest sleep state fitting into the predicted idle time.
+ *
+ * See `power_governor_menu`.
+ */
+static size_t menu_select(const struct system_sleep_state *states, size_t count, u64_us_t idle_time)
+{
+    u64_us_t predicted = idle_time;
+
+    // lower the prediction if the recent wake-ups were mostly early
+    u32_us_t early_sum = 0;
+    uint32_t early_count = 0;
+
+    for (size_t i = 0; i < history_count; i++) {
+        if (history[i].early) {
+            early_sum += history[i].measured_time;
+            early_count++;
+        }
+    }
+
+    if ((early_count > 0) && (2 * early_count >= POWER_HISTORY_SIZE)) {
+        u32_us_t early_average = early_sum / early_count;
+
+        if (early_average < predicted) {
+            predicted = early_average;
+        }
+    }
+
+    // find deepest state which fits into the predicted idle time
+    for (size_t i = count - 1; i > 0; i--) {
+        u64_us_t latency = (u64_us_t) states[i].entry_latency + states[i].exit_latency;
+
+        if ((predicted >= latency) && (predicted >= states[i].min_residency)) {
+            return i;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Records a wake-up in the history of the menu governor.
+ */
+static void menu_reflect(size_t state, u64_us_t idle_time, u64_us_t measured_time)
+{
+    ARG_UNUSED(state);
+
+    // a wake-up counts as early if it happened more than 1/8 of the idle time before the scheduled time,
+    // sleeping without scheduled wake-up is always terminated early by an interrupt
+    history[history_index].measured_time = limit_time(measured_time);
+    history[history_index].early = (measured_time < idle_time - (idle_time / 8));
+
+    history_index = (history_index + 1) % POWER_HISTORY_SIZE;
+
+    if (history_count < POWER_HISTORY_SIZE) {
+        history_count++;
+    }
+}
+
+/**
+ * Helper function to limit a time value to `POWER_HISTORY_MAX_TIME`.
+ *
+ * @param value Value to limit.
+ * @return Limited value.
+ */
+static u32_us_t limit_time(u64_us_t value)
+{
+    return (value > POWER_HISTORY_MAX_TIME) ? POWER_HISTORY_MAX_TIME : (u32_us_t) value;
+}
@@ -0,0 +1,280 @@
+#include <service/stream_buffer.h>
+#include <string.h>
+
+#define MESSAGE_HEADER_SIZE       sizeof(uint32_t)
+#define MESSAGE_COMMITTED         (1UL << 31)
+#define MESSAGE_LENGTH_MASK       (MESSAGE_COMMITTED - 1)
+
+static void region_at(struct stream_buffer *buffer, uint32_t position, size_t length,
+                      struct stream_buffer_region *region);
+static uint32_t *header_at(struct stream_buffer *buffer, uint32_t position);
+static uint32_t record_size(size_t length);
+
+size_t stream_buffer_reserve(struct stream_buffer *buffer, size_t length, struct stream_buffer_region *region)
+{
+    uint32_t read = __atomic_load_n(&buffer->read, __ATOMIC_ACQUIRE);
+    size_t available = buffer->size - (buffer->write - read);
+
+    if (length > available) {
+        length = available;
+    }
+
+    region_at(buffer, buffer->write, length, region);
+
+    return length;
+}
+
+void stream_buffer_commit(struct stream_buffer *buffer, size_t length)
+{
+    __atomic_store_n(&buffer->write, buffer->write + (uint32_t) length, __ATOMIC_RELEASE);
+}
+
+size_t stream_buffer_write(struct stream_buffer *buffer, const void *data, size_t length)
+{
+    struct stream_buffer_region region;
+
+    length = stream_buffer_reserve(buffer, length, &region);
+    stream_buffer_region_copy_in(&region, data);
+    stream_buffer_commit(buffer, length);
+
+    return length;
+}
+
+size_t stream_buffer_peek(struct stream_buffer *buffer, struct stream_buffer_region *region)
+{
+    uint32_t write = __atomic_load_n(&buffer->write, __ATOMIC_ACQUIRE);
+    size_t length = write - buffer->read;
+
+    region_at(buffer, buffer->read, length, region);
+
+    return length;
+}
+
+void stream_buffer_consume(struct stream_buffer *buffer, size_t length)
+{
+    __atomic_store_n(&buffer->read, buffer->read + (uint32_t) length, __ATOMIC_RELEASE);
+}
+
+size_t stream_buffer_read(struct stream_buffer *buffer, void *data, size_t length)
+{
+    struct stream_buffer_region region;
+    size_t available = stream_buffer_peek(buffer, &region);
+
+    if (length > available) {
+        length = available;
+    }
+
+    // only copy the requested part
+    region_at(buffer, buffer->read, length, &region);
+    stream_buffer_region_copy_out(&region, data);
+    stream_buffer_consume(buffer, length);
+
+    return length;
+}
+
+bool_t stream_buffer_message_reserve(struct stream_buffer *buffer, size_t length,
+                                     struct stream_buffer_region *region)
+{
+    uint32_t size = record_size(length);
+    uint32_t write = __atomic_load_n(&buffer->write, __ATOMIC_RELAXED);
+
+    // claim the space by advancing the write position, retried if another producer was faster
+    do {
+        uint32_t read = __atomic_load_n(&buffer->read, __ATOMIC_ACQUIRE);
+
+        if ((length > MESSAGE_LENGTH_MASK) || (size > buffer->size - (write - read))) {
+            __atomic_fetch_add(&buffer->overflows, 1, __ATOMIC_RELAXED);
+            return false;
+        }
+    } while (!__atomic_compare_exchange_n(&buffer->write, &write, write + size, true, __ATOMIC_ACQ_REL,
+                                          __ATOMIC_RELAXED));
+
+    // the consumer cleared the header, so the message is not committed until the content is written
+    __atomic_store_n(header_at(buffer, write), (uint32_t) length, __ATOMIC_RELAXED);
+
+    region_at(buffer, write + MESSAGE_HEADER_SIZE, length, region);
+    region->position = write;
+
+    return true;
+}
+
+void stream_buffer_message_commit(struct stream_buffer *buffer, const struct stream_buffer_region *region)
+{
+    __atomic_fetch_or(header_at(buffer, region->position), MESSAGE_COMMITTED, __ATOMIC_RELEASE);
+}
+
+bool_t stream_buffer_message_put(struct stream_buffer *buffer, const void *data, size_t length)
+{
+    struct stream_buffer_region region;
+
+    if (!stream_buffer_message_reserve(buffer, length, &region)) {
+        return false;
+    }
+
+    stream_buffer_region_copy_in(&region, data);
+    stream_buffer_message_commit(buffer, &region);
+
+    return true;
+}
+
+bool_t stream_buffer_message_peek(struct stream_buffer *buffer, struct stream_buffer_region *region)
+{
+    return stream_buffer_message_peek_at(buffer, buffer->read, region);
+}
+
+void stream_buffer_message_consume(struct stream_buffer *buffer)
+{
+    struct stream_buffer_region region;
+
+    if (stream_buffer_message_peek(buffer, &region)) {
+        stream_buffer_message_consume_to(buffer, stream_buffer_message_next(&region));
+    }
+}
+
+bool_t stream_buffer_message_peek_at(struct stream_buffer *buffer, uint32_t position,
+                                     struct stream_buffer_region *region)
+{
+    if (__atomic_load_n(&buffer->write, __ATOMIC_ACQUIRE) == position) {
+        return false;
+    }
+
+    uint32_t header = __atomic_load_n(header_at(buffer, position), __ATOMIC_ACQUIRE);
+
+    if ((header & MESSAGE_COMMITTED) == 0) {
+        return false;
+    }
+
+    region_at(buffer, position + MESSAGE_HEADER_SIZE, header & MESSAGE_LENGTH_MASK, region);
+    region->position = position;
+
+    return true;
+}
+
+uint32_t stream_buffer_message_next(const struct stream_buffer_region *region)
+{
+    return region->position + record_size(region->length[0] + region->length[1]);
+}
+
+void stream_buffer_message_consume_to(struct stream_buffer *buffer, uint32_t position)
+{
+    uint32_t read = buffer->read;
+
+    // producers write the header only after reserving, so stale data must not look like a committed header
+    struct stream_buffer_region region;
+    region_at(buffer, read, position - read, &region);
+
+    memset(region.data[0], 0, region.length[0]);
+    memset(region.data[1], 0, region.length[1]);
+
+    __atomic_store_n(&buffer->read, position, __ATOMIC_RELEASE);
+}
+
+void stream_buffer_region_copy_in(const struct stream_buffer_region *region, const void *data)
+{
+    stream_buffer_region_write(region, 0, data, region->length[0] + region->length[1]);
+}
+
+size_t stream_buffer_region_copy_out(const struct stream_buffer_region *region, void *data)
+{
+    size_t length = region->length[0] + region->length[1];
+
+    stream_buffer_region_read(region, 0, data, length);
+    return length;
+}
+
+void stream_buffer_region_write(const struct stream_buffer_region *region, size_t offset, const void *data,
+                                size_t length)
+{
+    const uint8_t *source = data;
+
+    // part within the first segment
+    if (offset < region->length[0]) {
+        size_t first = region->length[0] - offset;
+
+        if (first > length) {
+            first = length;
+        }
+
+        memcpy(region->data[0] + offset, source, first);
+        source += first;
+        length -= first;
+        offset = region->length[0];
+    }
+
+    if (length > 0) {
+        memcpy(region->data[1] + (offset - region->length[0]), source, length);
+    }
+}
+
+void stream_buffer_region_read(const struct stream_buffer_region *region, size_t offset, void *data, size_t length)
+{
+    uint8_t *destination = data;
+
+    // part within the first segment
+    if (offset < region->length[0]) {
+        size_t first = region->length[0] - offset;
+
+        if (first > length) {
+            first = length;
+        }
+
+        memcpy(destination, region->data[0] + offset, first);
+        destination += first;
+        length -= first;
+        offset = region->length[0];
+    }
+
+    if (length > 0) {
+        memcpy(destination, region->data[1] + (offset - region->length[0]), length);
+    }
+}
+
+/**
+ * Helper function to get the region starting at a position.
+ *
+ * @param buffer Stream buffer.
+ * @param position Start position, wrapped by the buffer size.
+ * @param length Length of the region in bytes, must not exceed the buffer size.
+ * @param region Region to fill.
+ */
+static void region_at(struct stream_buffer *buffer, uint32_t position, size_t length,
+                      struct stream_buffer_region *region)
+{
+    uint32_t offset = position & (buffer->size - 1);
+    size_t first = buffer->size - offset;
+
+    if (first > length) {
+        first = length;
+    }
+
+    region->data[0] = buffer->data + offset;
+    region->length[0] = first;
+    region->data[1] = buffer->data;
+    region->length[1] = length - first;
+    region->position = position;
+}
+
+/**
+ * Helper function to get the header of the message at a position.
+ *
+ * Headers are 4 byte aligned and therefore never wrap around.
+ *
+ * @param buffer Message buffer.
+ * @param position Position of the message.
+ * @return Header.
+ */
+static uint32_t *header_at(struct stream_buffer *buffer, uint32_t position)
+{
+    return (uint32_t *) (buffer->data + (position & (buffer->size - 1)));
+}
+
+/**
+ * Helper function to get the size of a message including header and padding.
+ *
+ * @param length Length of the message content in bytes.
+ * @return Size in the buffer in bytes.
+ */
+static uint32_t record_size(size_t length)
+{
+    return MESSAGE_HEADER_SIZE + (((uint32_t) length + 3U) & ~3U);
+}
@@ -0,0 +1,58 @@
+#include <service/throttle.h>
+#include <service/system.h>
+#include <service/assert.h>
+#include <util/container_of.h>
+
+void throttle_trigger(struct throttle *throttle)
+{
+    RUNTIME_ASSERT((throttle->options & (THROTTLE_LEADING | THROTTLE_TRAILING)) != 0);
+
+    system_critical_section_enter();
+
+    if (!throttle->active) {
+        // first event starts a new period
+        throttle->active = true;
+        work_schedule_after(&throttle->work, throttle->period);
+
+        if ((throttle->options & THROTTLE_LEADING) != 0) {
+            work_submit(throttle->target);
+        } else {
+            throttle->pending = true;
+        }
+    } else if (((throttle->options & THROTTLE_TRAILING) != 0) && !throttle->pending) {
+        throttle->pending = true;
+    } else {
+        throttle->suppressed++;
+    }
+
+    system_critical_section_exit();
+}
+
+void throttle_cancel(struct throttle *throttle)
+{
+    system_critical_section_enter();
+
+    throttle->active = false;
+    throttle->pending = false;
+    work_cancel(&throttle->work);
+
+    system_critical_section_exit();
+}
+
+void throttle_work_handler(struct work *work)
+{
+    struct throttle *throttle = CONTAINER_OF(work, struct throttle, work);
+
+    system_critical_section_enter();
+
+    if (throttle->pending) {
+        // trailing submission starts another period
+        throttle->pending = false;
+        work_submit(throttle->target);
+        work_schedule_again(&throttle->work, throttle->period);
+    } else {
+        throttle->active = false;
+    }
+
+    system_critical_section_exit();
+}
@@ -1,27 +1,57 @@
 #include <service/work.h>
 #include <service/system.h>
+#include <service/power.h>
 #include <service/assert.h>
 #include <util/unused.h>
 
+#define WORK_ITEM_FLAGS_ALL    (WORK_ITEM_RUNNING | WORK_ITEM_SUBMITTED | WORK_ITEM_SCHEDULED | WORK_ITEM_IDLE | WORK_ITEM_ISR | \
+                                WORK_ITEM_BATCH)
+
+// rounded up so that coarse tick rates don't shrink the idle time slice to zero
+#define IDLE_TIME_SLICE_TICKS    SYSTEM_US_TO_TICKS_CEIL(WORK_IDLE_TIME_SLICE_US)
+
+#ifdef WORK_COMPACT_LAYOUT
+BUILD_ASSERT(sizeof(work_deadline_t) == sizeof(uint32_t));
+BUILD_ASSERT(sizeof(struct work) == 2 * sizeof(void *) + 2 * sizeof(uint32_t));
+#else
+BUILD_ASSERT(sizeof(struct work) == 2 * sizeof(void *) + sizeof(u64_tick_t) + 2 * sizeof(uint32_t));
+#endif
+
+BUILD_ASSERT((work_flags_t) WORK_ITEM_FLAGS_ALL == WORK_ITEM_FLAGS_ALL);
+BUILD_ASSERT(WORK_IDLE_TIME_SLICE_US > 0);
+BUILD_ASSERT(WORK_IDLE_MIN_SLICE_US > 0);
+
 static volatile bool_t running = false;
 static struct work *submitted_queue = NULL;
 static struct work *scheduled_queue = NULL;
+static struct work *idle_queue = NULL;
+static u64_tick_t idle_slice_end = 0;
 
 static bool_t process_next_work(struct work **queue);
+static bool_t process_idle_work();
 static void submit_ready_work();
 static void sleep_until_ready();
+static u64_us_t time_until_ready();
+static void run_ready_isr_work_locked(work_deadline_t current_uptime);
+static void wakeup_isr_work_locked();
+static bool_t idle_allowed_locked(u64_tick_t current_uptime);
 
+static struct work **submit_queue_of(struct work *work);
 static void submit_add_locked(struct work **queue, struct work *work);
-static void schedule_add_locked(struct work *work, u64_ms_t scheduled_uptime);
+static void schedule_at(struct work *work, work_deadline_t deadline);
+static void schedule_add_locked(struct work *work, work_deadline_t scheduled_uptime);
 static void remove_locked(struct work **queue, struct work *work, uint32_t flags_to_clear);
+static u64_tick_t delay_to_ticks(u32_ms_t delay);
+static u64_tick_t deadline_to_uptime(work_deadline_t deadline, u64_tick_t current_uptime);
 
 static void set_flags(struct work *work, uint32_t flags);
 static void clear_flags(struct work *work, uint32_t flags);
 static bool_t test_flags_any(struct work *work, uint32_t flags);
+static bool_t same_batch(struct work *first, struct work *work);
 
 #ifdef BUILD_UNIT_TEST
 static void stop_request_handler(struct work *work);
-static WORK_DEFINE(stop_request_work, INT32_MAX, stop_request_handler);
+static WORK_DEFINE(stop_request_work, WORK_PRIORITY_LOWEST, stop_request_handler);
 #endif
 
 void work_run(void)
@@ -29,14 +59,30 @@ void work_run(void)
     running = true;
 
     while (running) {
-        submit_ready_work();
-
-        if (!process_next_work(&submitted_queue)) {
+        if (!work_run_once()) {
             sleep_until_ready();
         }
     }
 }
 
+bool_t work_run_once(void)
+{
+    submit_ready_work();
+
+    return process_next_work(&submitted_queue) || process_idle_work();
+}
+
+u64_us_t work_poll(void)
+{
+    do {
+        submit_ready_work();
+    } while (process_next_work(&submitted_queue));
+
+    process_idle_work();
+
+    return time_until_ready();
+}
+
 #ifdef BUILD_UNIT_TEST
 void work_run_for(u32_ms_t duration)
 {
@@ -47,6 +93,8 @@ void work_run_for(u32_ms_t duration)
 
 void work_submit(struct work *work)
 {
+    RUNTIME_ASSERT(!test_flags_any(work, WORK_ITEM_ISR));
+
     system_critical_section_enter();
 
     // if item is already submitted, do nothing
@@ -60,30 +108,38 @@ void work_submit(struct work *work)
         remove_locked(&scheduled_queue, work, WORK_ITEM_SCHEDULED);
     }
 
-    submit_add_locked(&submitted_queue, work);
+    submit_add_locked(submit_queue_of(work), work);
 
     system_critical_section_exit();
 }
 
 void work_schedule_after(struct work *work, u32_ms_t delay)
 {
-    work_schedule_at(work, system_uptime_get_ms() + delay);
+    schedule_at(work, (work_deadline_t) (system_uptime_get_ticks() + delay_to_ticks(delay)));
 }
 
 void work_schedule_again(struct work *work, u32_ms_t delay)
 {
-    work_schedule_at(work, work->scheduled_uptime + delay);
+    schedule_at(work, (work_deadline_t) (work->scheduled_uptime + delay_to_ticks(delay)));
 }
 
 void work_schedule_at(struct work *work, u64_ms_t uptime)
 {
-    system_critical_section_enter();
+    u64_tick_t deadline = SYSTEM_MS_TO_TICKS(uptime);
 
-    if (!test_flags_any(work, WORK_ITEM_SCHEDULED | WORK_ITEM_SUBMITTED)) {
-        schedule_add_locked(work, uptime);
+#ifdef WORK_COMPACT_LAYOUT
+    u64_tick_t current_uptime = system_uptime_get_ticks();
+
+    // wrapped deadlines can only be compared if they are less than INT32_MAX apart
+    RUNTIME_ASSERT((deadline < current_uptime) || (deadline - current_uptime <= INT32_MAX));
+
+    // a past deadline is ready now, however long ago it was
+    if (deadline < current_uptime) {
+        deadline = current_uptime;
     }
+#endif
 
-    system_critical_section_exit();
+    schedule_at(work, (work_deadline_t) deadline);
 }
 
 void work_cancel(struct work *work)
@@ -95,31 +151,53 @@ void work_cancel(struct work *work)
     }
 
     if (test_flags_any(work, WORK_ITEM_SUBMITTED)) {
-        remove_locked(&submitted_queue, work, WORK_ITEM_SUBMITTED);
+        remove_locked(submit_queue_of(work), work, WORK_ITEM_SUBMITTED);
     }
 
     system_critical_section_exit();
 }
 
+bool_t work_idle_should_yield(void)
+{
+    system_critical_section_enter();
+    bool_t pending = (submitted_queue != NULL);
+    system_critical_section_exit();
+
+    return pending || (system_uptime_get_ticks() >= idle_slice_end);
+}
+
+void work_wakeup_handler(void)
+{
+    system_critical_section_enter();
+
+    run_ready_isr_work_locked((work_deadline_t) system_uptime_get_ticks());
+    wakeup_isr_work_locked();
+
+    system_critical_section_exit();
+}
+
 /**
  * Submits all work items from the scheduled queue which are ready.
  */
 static void submit_ready_work()
 {
-    u64_ms_t current_uptime = system_uptime_get_ms();
+    work_deadline_t current_uptime = (work_deadline_t) system_uptime_get_ticks();
 
     system_critical_section_enter();
 
+    // the wake-up interrupt usually executed them already, but don't rely on its timing
+    run_ready_isr_work_locked(current_uptime);
+
     struct work *work = scheduled_queue;
 
     // submit items
-    while ((work != NULL) && (work->scheduled_uptime <= current_uptime)) {
+    while ((work != NULL) && !work_deadline_before(current_uptime, work->scheduled_uptime)) {
         struct work *next = work->next;
 
         clear_flags(work, WORK_ITEM_SCHEDULED);
         work->next = NULL;
 
-        submit_add_locked(&submitted_queue, work);
+        submit_add_locked(submit_queue_of(work), work);
 
         work = next;
     }
@@ -133,11 +211,18 @@ static void submit_ready_work()
 /**
  * Processes the first queued item, if any.
  *
+ * If the first item is a batch item, all consecutive items of the same batch are processed with a single call
+ * of the batch handler.
+ *
+ * @param queue Queue to take the item from.
  * @return True if an item was processed, false if there was none.
  */
 static bool_t process_next_work(struct work **queue)
 {
-    // remove first item from queue and update state
+    struct work *batch[WORK_BATCH_MAX];
+    size_t count = 0;
+
+    // remove first item and consecutive items of the same batch from queue and update state
     system_critical_section_enter();
 
     struct work *work = *queue;
@@ -147,25 +232,75 @@ static bool_t process_next_work(struct work **queue)
         return false;
     }
 
-    *queue = work->next;
+    do {
+        *queue = work->next;
+
+        clear_flags(work, WORK_ITEM_SUBMITTED);
+        set_flags(work, WORK_ITEM_RUNNING);
+        work->next = NULL;
 
-    clear_flags(work, WORK_ITEM_SUBMITTED);
-    set_flags(work, WORK_ITEM_RUNNING);
-    work->next = NULL;
+        batch[count++] = work;
+        work = *queue;
+    } while ((count < WORK_BATCH_MAX) && (work != NULL) && same_batch(batch[0], work));
 
     system_critical_section_exit();
 
-    // process item
-    work->handler(work);
+    // process items
+    if (test_flags_any(batch[0], WORK_ITEM_BATCH)) {
+        ((work_batch_handler_t) (void (*)(void)) batch[0]->handler)(batch, count);
+    } else {
+        batch[0]->handler(batch[0]);
+    }
 
     // update state
     system_critical_section_enter();
-    clear_flags(work, WORK_ITEM_RUNNING);
+
+    for (size_t i = 0; i < count; i++) {
+        clear_flags(batch[i], WORK_ITEM_RUNNING);
+    }
+
     system_critical_section_exit();
 
     return true;
 }
 
+/**
+ * Processes the first idle item, if any.
+ *
+ * The time slice of the item ends after `WORK_IDLE_TIME_SLICE_US` or when the next scheduled item
+ * becomes ready, whichever is earlier. No item is started if the next scheduled item is ready within
+ * `WORK_IDLE_MIN_SLICE_US`.
+ *
+ * @return True if an item was processed, false if there was none or the next scheduled item is about to become ready.
+ */
+static bool_t process_idle_work()
+{
+    u64_tick_t current_uptime = system_uptime_get_ticks();
+    u64_tick_t slice_end = current_uptime + IDLE_TIME_SLICE_TICKS;
+
+    system_critical_section_enter();
+
+    // let the scheduled item run first, it is submitted once it is ready
+    if (!idle_allowed_locked(current_uptime)) {
+        system_critical_section_exit();
+        return false;
+    }
+
+    if (scheduled_queue != NULL) {
+        u64_tick_t wakeup_uptime = deadline_to_uptime(scheduled_queue->scheduled_uptime, current_uptime);
+
+        if (wakeup_uptime < slice_end) {
+            slice_end = wakeup_uptime;
+        }
+    }
+
+    idle_slice_end = slice_end;
+
+    system_critical_section_exit();
+
+    return process_next_work(&idle_queue);
+}
+
 /**
  * Enters sleep mode until the next scheduled work item becomes ready.
  */
@@ -173,27 +308,173 @@ static void sleep_until_ready()
 {
     system_critical_section_enter();
 
-    // don't go to sleep if there is still submitted work
-    if (submitted_queue != NULL) {
+    u64_tick_t current_uptime = system_uptime_get_ticks();
+
+    // don't go to sleep if there is still submitted work, idle items wait for an imminent scheduled item
+    if ((submitted_queue != NULL) || ((idle_queue != NULL) && idle_allowed_locked(current_uptime))) {
         system_critical_section_exit();
         return;
     }
 
+    u64_us_t idle_time = POWER_IDLE_TIME_INFINITE;
+
     if (scheduled_queue != NULL) {
-        u64_ms_t current_uptime = system_uptime_get_ms();
+        u64_tick_t wakeup_uptime = deadline_to_uptime(scheduled_queue->scheduled_uptime, current_uptime);
 
         // don't go to sleep if there is ready work
-        if (scheduled_queue->scheduled_uptime < current_uptime) {
+        if (wakeup_uptime < current_uptime) {
             system_critical_section_exit();
             return;
         }
 
-        system_wakeup_schedule_at(scheduled_queue->scheduled_uptime);
+        system_wakeup_schedule_at(wakeup_uptime);
+        idle_time = SYSTEM_TICKS_TO_US(wakeup_uptime - current_uptime);
     }
 
-    system_enter_sleep_mode();
+    power_sleep(idle_time);
+
+    system_critical_section_exit();
+}
+
+/**
+ * Computes the time until the next item is ready.
+ *
+ * @return Time in microseconds, zero if an item is ready or `WORK_POLL_INFINITE` if no item is scheduled.
+ */
+static u64_us_t time_until_ready()
+{
+    u64_us_t ret = WORK_POLL_INFINITE;
+
+    system_critical_section_enter();
+
+    u64_tick_t current_uptime = system_uptime_get_ticks();
+
+    if ((submitted_queue != NULL) || ((idle_queue != NULL) && idle_allowed_locked(current_uptime))) {
+        ret = 0;
+    } else if (scheduled_queue != NULL) {
+        u64_tick_t ready_uptime = deadline_to_uptime(scheduled_queue->scheduled_uptime, current_uptime);
+
+        ret = (ready_uptime > current_uptime) ? SYSTEM_TICKS_TO_US(ready_uptime - current_uptime) : 0;
+    }
 
     system_critical_section_exit();
+
+    return ret;
+}
+
+/**
+ * Executes expired timer items from the scheduled queue.
+ *
+ * Interrupts must be locked.
+ *
+ * @param current_uptime Current uptime in ticks.
+ */
+static void run_ready_isr_work_locked(work_deadline_t current_uptime)
+{
+    struct work *previous = NULL;
+    struct work **link = &scheduled_queue;
+
+    while ((*link != NULL) && !work_deadline_before(current_uptime, (*link)->scheduled_uptime)) {
+        struct work *work = *link;
+
+        // regular items are left for submit_ready_work()
+        if (!test_flags_any(work, WORK_ITEM_ISR)) {
+            previous = work;
+            link = &work->next;
+            continue;
+        }
+
+        *link = work->next;
+
+        clear_flags(work, WORK_ITEM_SCHEDULED);
+        set_flags(work, WORK_ITEM_RUNNING);
+        work->next = NULL;
+
+        work->handler(work);
+
+        clear_flags(work, WORK_ITEM_RUNNING);
+
+        // continue after the previous regular item unless the handler took it out of the queue
+        if ((previous != NULL) && !test_flags_any(previous, WORK_ITEM_SCHEDULED)) {
+            previous = NULL;
+            link = &scheduled_queue;
+        }
+    }
+}
+
+/**
+ * Programs the wake-up timer for the earliest scheduled timer item, if any.
+ *
+ * Interrupts must be locked.
+ */
+static void wakeup_isr_work_locked()
+{
+    struct work *work = scheduled_queue;
+
+    while ((work != NULL) && !test_flags_any(work, WORK_ITEM_ISR)) {
+        work = work->next;
+    }
+
+    if (work != NULL) {
+        system_wakeup_schedule_at(deadline_to_uptime(work->scheduled_uptime, system_uptime_get_ticks()));
+    }
+}
+
+/**
+ * Checks if idle items may be started, which is not the case if the next scheduled item becomes ready within
+ * `WORK_IDLE_MIN_SLICE_US`.
+ *
+ * Interrupts must be locked.
+ *
+ * @param current_uptime Current uptime in ticks.
+ * @return True if idle items may be started, false otherwise.
+ */
+static bool_t idle_allowed_locked(u64_tick_t current_uptime)
+{
+    if (scheduled_queue == NULL) {
+        return true;
+    }
+
+    u64_tick_t wakeup_uptime = deadline_to_uptime(scheduled_queue->scheduled_uptime, current_uptime);
+
+    // part of the current tick may have elapsed already, so round up from the uptime in microseconds, which also
+    // keeps the margin at least one tick
+    u64_tick_t earliest_uptime = SYSTEM_US_TO_TICKS_CEIL(system_uptime_get_us() + WORK_IDLE_MIN_SLICE_US);
+
+    return wakeup_uptime >= earliest_uptime;
+}
+
+/**
+ * Schedules an item at the specified deadline unless it is already scheduled or submitted.
+ *
+ * @param work Item to schedule.
+ * @param deadline Uptime at which the item shall be submitted.
+ */
+static void schedule_at(struct work *work, work_deadline_t deadline)
+{
+    system_critical_section_enter();
+
+    if (!test_flags_any(work, WORK_ITEM_SCHEDULED | WORK_ITEM_SUBMITTED)) {
+        schedule_add_locked(work, deadline);
+
+        // timer items must not wait until the work queue goes to sleep
+        if (test_flags_any(work, WORK_ITEM_ISR)) {
+            wakeup_isr_work_locked();
+        }
+    }
+
+    system_critical_section_exit();
+}
+
+/**
+ * Helper function to get the queue an item is added to when submitted.
+ *
+ * @param work Work item.
+ * @return Idle queue for idle items, submitted queue otherwise.
+ */
+static struct work **submit_queue_of(struct work *work)
+{
+    return test_flags_any(work, WORK_ITEM_IDLE) ? &idle_queue : &submitted_queue;
 }
 
 /**
@@ -240,14 +521,14 @@ static void submit_add_locked(struct work **queue, struct work *work)
  * @param work Item to add.
  * @param scheduled_uptime Uptime at which the item shall be scheduled.
  */
-static void schedule_add_locked(struct work *work, u64_ms_t scheduled_uptime)
+static void schedule_add_locked(struct work *work, work_deadline_t scheduled_uptime)
 {
     struct work *previous = NULL;
     struct work *next = scheduled_queue;
 
     // find correct position to insert
     while (next != NULL) {
-        if (next->scheduled_uptime > scheduled_uptime) {
+        if (work_deadline_before(scheduled_uptime, next->scheduled_uptime)) {
             break;
         }
 
@@ -300,6 +581,42 @@ static void remove_locked(struct work **queue, struct work *work, uint32_t flags
     }
 }
 
+/**
+ * Helper function to convert a delay into ticks.
+ *
+ * @param delay Delay in milliseconds.
+ * @return Delay in ticks.
+ */
+static u64_tick_t delay_to_ticks(u32_ms_t delay)
+{
+    u64_tick_t ticks = SYSTEM_MS_TO_TICKS(delay);
+
+#ifdef WORK_COMPACT_LAYOUT
+    // wrapped deadlines can only be compared if they are less than INT32_MAX apart
+    RUNTIME_ASSERT(ticks <= INT32_MAX);
+#endif
+
+    return ticks;
+}
+
+/**
+ * Helper function to convert a deadline into the full uptime.
+ *
+ * @param deadline Deadline of a scheduled item.
+ * @param current_uptime Current uptime in ticks.
+ * @return Uptime in ticks at which the deadline expires.
+ */
+static u64_tick_t deadline_to_uptime(work_deadline_t deadline, u64_tick_t current_uptime)
+{
+#ifdef WORK_COMPACT_LAYOUT
+    // the wrapped deadline is at most INT32_MAX away from the current uptime
+    return current_uptime + (int32_t) (deadline - (work_deadline_t) current_uptime);
+#else
+    ARG_UNUSED(current_uptime);
+    return deadline;
+#endif
+}
+
 /**
  * Helper function to set the specified flags on a work item.
  *
@@ -334,6 +651,19 @@ static bool_t test_flags_any(struct work *work, uint32_t flags)
     return (work->flags & flags) != 0;
 }
 
+/**
+ * Helper function to check if a work item can be processed in the same batch as another item.
+ *
+ * @param first First item of the batch.
+ * @param work Work item.
+ * @return True, if both are batch items with the same handler and priority. False, otherwise.
+ */
+static bool_t same_batch(struct work *first, struct work *work)
+{
+    return test_flags_any(first, WORK_ITEM_BATCH) && test_flags_any(work, WORK_ITEM_BATCH) &&
+           (work->handler == first->handler) && (work->priority == first->priority);
+}
+
 #ifdef BUILD_UNIT_TEST
 static void stop_request_handler(struct work *work)
 {
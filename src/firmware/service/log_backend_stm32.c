@@ -0,0 +1,61 @@
+#include <service/log_backend_stm32.h>
+#include <service/assert.h>
+#include <util/unused.h>
+#include <stm32f4xx_hal.h>
+
+#define LOG_BACKEND_STM32_BUFFER_SIZE    1024
+
+extern UART_HandleTypeDef huart2;
+
+static void transmit(struct log_backend *backend, const uint8_t *data, size_t length);
+static size_t panic(struct log_backend *backend);
+
+static const struct log_backend_api api = {
+    .transmit = transmit,
+    .panic = panic,
+};
+
+LOG_BACKEND_DEFINE(log_backend_uart, &api, LOG_BACKEND_STM32_BUFFER_SIZE, DEFAULT_LOG_LEVEL);
+
+void log_backend_stm32_setup(void)
+{
+    log_backend_register(&log_backend_uart);
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    if (huart == &huart2) {
+        log_backend_transmit_done(&log_backend_uart);
+    }
+}
+
+/**
+ * Starts an interrupt driven transmission.
+ *
+ * @param backend Backend.
+ * @param data Data to transmit.
+ * @param length Length of the data in bytes.
+ */
+static void transmit(struct log_backend *backend, const uint8_t *data, size_t length)
+{
+    ARG_UNUSED(backend);
+
+    HAL_StatusTypeDef status = HAL_UART_Transmit_IT(&huart2, data, (uint16_t) length);
+    RUNTIME_ASSERT(status == HAL_OK);
+}
+
+/**
+ * Aborts the ongoing transmission, so the UART can be used by `system_debug_out()`.
+ *
+ * @param backend Backend.
+ * @return Number of bytes already transmitted.
+ */
+static size_t panic(struct log_backend *backend)
+{
+    ARG_UNUSED(backend);
+
+    size_t transmitted = huart2.TxXferSize - huart2.TxXferCount;
+    HAL_UART_AbortTransmit(&huart2);
+
+    return transmitted;
+}
@@ -1,5 +1,7 @@
 #include <service/system.h>
 #include <service/log.h>
+#include <service/assert.h>
+#include <service/work.h>
 #include <stm32f4xx_hal.h>
 #include <main.h>
 
@@ -8,6 +10,11 @@ extern TIM_HandleTypeDef htim3;  ///< 16 bit timer for wakeup (10 kHz clock)
 
 extern UART_HandleTypeDef huart2;
 
+// stop and standby modes halt TIM2/TIM3 and would require the RTC as uptime and wake-up source
+static const struct system_sleep_state sleep_states[] = {
+    {"sleep", 0, 2, 0},
+};
+
 static uint32_t uptime_high32 = 0;
 static uint32_t critical_section_depth = 0;
 
@@ -44,6 +51,12 @@ u64_us_t system_uptime_get_us(void)
     return ((u64_us_t) high32 << 32) | (u64_us_t) low32;
 }
 
+u64_tick_t system_uptime_get_ticks(void)
+{
+    // no conversion needed if the tick rate matches the 1 MHz uptime counter
+    return SYSTEM_US_TO_TICKS(system_uptime_get_us());
+}
+
 u64_ms_t system_uptime_get_ms(void)
 {
     return system_uptime_get_us() / 1000;
@@ -63,21 +76,26 @@ void system_busy_sleep_us(u64_us_t delay)
     }
 }
 
-void system_wakeup_schedule_at(u64_ms_t uptime)
+void system_wakeup_schedule_at(u64_tick_t uptime)
 {
-    u64_us_t now = system_uptime_get_us();
-    uint64_t timer_period;
-
-    if ((now / 1000) < uptime) {
-        timer_period = (uptime * 10) - (now / 100);
-    } else {
-        // results in smallest reload value 1
-        timer_period = 2;
+    u64_tick_t now = system_uptime_get_ticks();
+    uint32_t timer_period = 0;
+
+    if (now < uptime) {
+        u64_us_t delay = SYSTEM_TICKS_TO_US(uptime - now);
+
+        // timer is 16 bit, if a larger timeout is requested we schedule as late as we can
+        if (delay > 0x10000 * 100) {
+            timer_period = 0x10000;
+        } else {
+            // timer runs at 10 kHz, round up to not wake up too early
+            timer_period = ((uint32_t) delay + 99) / 100;
+        }
     }
 
-    // timer is 16 bit, if a larger timeout is requested we schedule as late as we can
-    if (timer_period > 0x10000) {
-        timer_period = 0x10000;
+    // results in smallest reload value 1
+    if (timer_period < 2) {
+        timer_period = 2;
     }
 
     __HAL_TIM_DISABLE(&htim3);
@@ -90,8 +108,10 @@ void system_wakeup_schedule_at(u64_ms_t uptime)
     __HAL_TIM_ENABLE(&htim3);
 }
 
-void system_enter_sleep_mode(void)
+void system_enter_sleep_mode(size_t state)
 {
+    RUNTIME_ASSERT(state < sizeof(sleep_states) / sizeof(sleep_states[0]));
+
     HAL_SuspendTick();
     HAL_GPIO_WritePin(LD2_GPIO_Port, LD2_Pin, GPIO_PIN_RESET);
     HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
@@ -99,6 +119,12 @@ void system_enter_sleep_mode(void)
     HAL_ResumeTick();
 }
 
+size_t system_sleep_states_get(const struct system_sleep_state **states)
+{
+    *states = sleep_states;
+    return sizeof(sleep_states) / sizeof(sleep_states[0]);
+}
+
 void system_debug_out(char c)
 {
     HAL_UART_Transmit(&huart2, (const uint8_t*) &c, 1, HAL_MAX_DELAY);
@@ -126,5 +152,8 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
         // system timer expired: disable timer
         __HAL_TIM_DISABLE(&htim3);
         __HAL_TIM_DISABLE_IT(&htim3, TIM_IT_UPDATE);
+
+        // execute timer items, might program the timer again
+        work_wakeup_handler();
     }
 }
@@ -22,6 +22,7 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "application/application_main.h"
+#include "service/log_backend_stm32.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -103,6 +104,9 @@ int main(void)
   __HAL_TIM_ENABLE_IT(&htim2, TIM_IT_UPDATE);
   __HAL_TIM_ENABLE(&htim2);
 
+  // transmit log output asynchronously
+  log_backend_stm32_setup();
+
   application_main();
   /* USER CODE END 2 */
 
@@ -2,6 +2,7 @@
 #include <application/peripherals_sim.h>
 #include <service/system_sim.h>
 #include <service/adapter_sim.h>
+#include <service/log_backend_sim.h>
 #include <util/unused.h>
 
 int main(int argc, char *argv[])
@@ -10,6 +11,7 @@ int main(int argc, char *argv[])
     ARG_UNUSED(argv);
 
     system_setup();
+    log_backend_sim_setup();
     adapter_setup();
     peripherals_setup();
 
@@ -1,16 +1,16 @@
 #include <service/adapter_sim.h>
 #include <service/assert.h>
 #include <service/work.h>
+#include <service/event_source_sim.h>
 #include <service/log.h>
 #include <util/unused.h>
 
-#include <pthread.h>
 #include <unistd.h>
 #include <stdio.h>
 #include <stdarg.h>
 #include <sys/un.h>
 #include <sys/socket.h>
-#include <semaphore.h>
+#include <sys/epoll.h>
 #include <cjson/cJSON.h>
 
 #define ADAPTER_PRIORITY       20
@@ -22,31 +22,43 @@ struct adapter_message {
     cJSON *json;
 };
 
-static void *thread_handler(void *arg);
-static void handle_connection(int client_sock);
-static void parse_request(const uint8_t *request, size_t length);
-static void process_request(struct work *work);
+static void accept_handler(struct work *work);
+static void receive_handler(struct work *work);
+static void process_request(const char *data, size_t length);
 static char *vprintf_alloc(const char *format, va_list ap);
 
 static struct adapter *adapter_list;
+static int server_sock = -1;
+static int client_sock = -1;
 
-static cJSON *current_request;
-static sem_t request_processed;
-
-WORK_DEFINE(process_request_work, ADAPTER_PRIORITY, process_request);
+WORK_DEFINE(accept_work, ADAPTER_PRIORITY, accept_handler);
+WORK_DEFINE(receive_work, ADAPTER_PRIORITY, receive_handler);
+EVENT_SOURCE_DEFINE(server_source, &accept_work);
+EVENT_SOURCE_DEFINE(client_source, &receive_work);
 
 void adapter_setup()
 {
-    int ret = sem_init(&request_processed, 0, 1);
-    RUNTIME_ASSERT(ret == 0);
+    struct sockaddr_un server_addr;
+
+    server_sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    RUNTIME_ASSERT(server_sock >= 0);
+
+    memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sun_family = AF_UNIX;
+    snprintf(server_addr.sun_path, sizeof(server_addr.sun_path), "/tmp/%d.socket", getpid());
 
-    pthread_t thread;
+    unlink(server_addr.sun_path);
 
-    ret = pthread_create(&thread, NULL, thread_handler, NULL);
+    int ret = bind(server_sock, (struct sockaddr *) &server_addr, sizeof(server_addr));
     RUNTIME_ASSERT(ret == 0);
 
-    ret = pthread_detach(thread);
+    ret = listen(server_sock, 0);
     RUNTIME_ASSERT(ret == 0);
+
+    // connections and requests are handled by the work queue once the sockets are ready
+    event_source_add(&server_source, server_sock, EPOLLIN);
+
+    LOG_INF("Waiting for connection...");
 }
 
 void adapter_init(struct adapter *adapter, adapter_message_handler_t handler, const char *topic_format, ...)
@@ -100,83 +112,58 @@ bool_t adapter_check_string(const struct adapter_message *message, const char *e
     return strcmp(cJSON_GetStringValue(message->json), expected) == 0;
 }
 
-static void *thread_handler(void *arg)
+void accept_handler(struct work *work)
 {
-    ARG_UNUSED(arg);
-
-    LOG_INF("Adapter thread started.");
-
-    int ret, server_sock, client_sock;
-    struct sockaddr_un server_addr, client_addr;
-
-    server_sock = socket(AF_UNIX, SOCK_STREAM, 0);
-    RUNTIME_ASSERT(server_sock >= 0);
-
-    memset(&server_addr, 0, sizeof(server_addr));
-    server_addr.sun_family = AF_UNIX;
-    snprintf(server_addr.sun_path, sizeof(server_addr.sun_path), "/tmp/%d.socket", getpid());
-
-    unlink(server_addr.sun_path);
-
-    ret = bind(server_sock, (struct sockaddr *) &server_addr, sizeof(server_addr));
-    RUNTIME_ASSERT(ret == 0);
-
-    ret = listen(server_sock, 0);
-    RUNTIME_ASSERT(ret == 0);
-
-    while (true) {
-        LOG_INF("Waiting for connection...");
+    ARG_UNUSED(work);
 
-        socklen_t client_addr_len = sizeof(client_addr);
-        client_sock = accept(server_sock, (struct sockaddr *) &client_addr, &client_addr_len);
+    event_source_ready(&server_source);
 
-        if (client_sock < 0) {
-            LOG_ERR("Accepting connection failed.");
-            continue;
-        }
+    struct sockaddr_un client_addr;
+    socklen_t client_addr_len = sizeof(client_addr);
+    client_sock = accept(server_sock, (struct sockaddr *) &client_addr, &client_addr_len);
 
-        handle_connection(client_sock);
+    if (client_sock < 0) {
+        LOG_ERR("Accepting connection failed.");
+        return;
     }
 
-    return NULL;
+    LOG_INF("Client connected.");
+
+    // handle one connection at a time
+    event_source_remove(&server_source);
+    event_source_add(&client_source, client_sock, EPOLLIN);
 }
 
-void handle_connection(int client_sock)
+void receive_handler(struct work *work)
 {
-    LOG_INF("Client connected.");
+    ARG_UNUSED(work);
 
-    while (true) {
-        uint8_t request[MESSAGE_BUFFER_SIZE] = {0};
-        int length = read(client_sock, request, sizeof(request) - 1);
-        RUNTIME_ASSERT(length >= 0);
+    event_source_ready(&client_source);
 
-        if (length < 1) {
-            LOG_INF("Client disconnected.");
-            close(client_sock);
-            break;
-        }
+    char request[MESSAGE_BUFFER_SIZE] = {0};
+    int length = read(client_sock, request, sizeof(request) - 1);
 
-        LOG_DBG("%d bytes received.", length);
-        parse_request(request, length);
-    }
-}
+    if (length < 1) {
+        LOG_INF("Client disconnected.");
 
-void parse_request(const uint8_t *request, size_t length)
-{
-    cJSON *json = cJSON_ParseWithLength((const char *) request, length);
+        event_source_remove(&client_source);
+        close(client_sock);
+        client_sock = -1;
 
-    int ret = sem_wait(&request_processed);
-    RUNTIME_ASSERT(ret == 0);
+        event_source_add(&server_source, server_sock, EPOLLIN);
+        LOG_INF("Waiting for connection...");
+        return;
+    }
 
-    current_request = json;
-    work_submit(&process_request_work);
+    LOG_DBG("%d bytes received.", length);
+    process_request(request, length);
 }
 
-void process_request(struct work *work)
+void process_request(const char *data, size_t length)
 {
-    ARG_UNUSED(work);
+    cJSON *request = cJSON_ParseWithLength(data, length);
 
-    const char *topic = cJSON_GetStringValue(cJSON_GetObjectItem(current_request, "topic"));
+    const char *topic = cJSON_GetStringValue(cJSON_GetObjectItem(request, "topic"));
 
     if (topic == NULL) {
         LOG_ERR("Invalid request.");
@@ -195,7 +182,7 @@ void process_request(struct work *work)
 
     if ((adapter != NULL) && (adapter->handler != NULL)) {
         struct adapter_message message = {
-            .json = cJSON_GetObjectItem(current_request, "message"),
+            .json = cJSON_GetObjectItem(request, "message"),
         };
 
         adapter->handler(adapter, &message);
@@ -204,11 +191,7 @@ void process_request(struct work *work)
     }
 
 cleanup:
-    cJSON_Delete(current_request);
-    current_request = NULL;
-
-    int ret = sem_post(&request_processed);
-    RUNTIME_ASSERT(ret == 0);
+    cJSON_Delete(request);
 }
 
 char *vprintf_alloc(const char *format, va_list ap)
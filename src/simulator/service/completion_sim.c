@@ -0,0 +1,106 @@
+#include <service/completion_sim.h>
+#include <service/system.h>
+#include <service/assert.h>
+#include <util/container_of.h>
+
+#include <errno.h>
+#include <semaphore.h>
+
+/**
+ * Continuation waking up a thread blocked in `completion_wait()`.
+ */
+struct completion_waiter {
+    struct completion_continuation continuation; ///< Continuation registered at the completion.
+    sem_t semaphore; ///< Semaphore the thread waits on.
+    bool_t initialized; ///< True once the continuation and semaphore were initialized.
+    bool_t used; ///< True while a call of `completion_wait()` owns the waiter.
+};
+
+static struct completion_waiter *waiter_acquire(void);
+static void waiter_release(struct completion_waiter *waiter);
+static void wake_waiter(struct work *work);
+
+// the work queue still accesses a continuation after its handler returned, so the waiters are not on the stack
+static struct completion_waiter waiters[COMPLETION_SIM_MAX_WAITERS];
+
+void completion_wait(struct completion *completion)
+{
+    if (completion_is_done(completion)) {
+        return;
+    }
+
+    struct completion_waiter *waiter = waiter_acquire();
+
+    completion_then(completion, &waiter->continuation);
+
+    int ret;
+
+    do {
+        ret = sem_wait(&waiter->semaphore);
+    } while ((ret != 0) && (errno == EINTR));
+
+    RUNTIME_ASSERT(ret == 0);
+
+    waiter_release(waiter);
+}
+
+/**
+ * Takes an unused waiter for a single call of `completion_wait()`.
+ *
+ * A released waiter was submitted by its completion and is no longer registered, so it can be registered again.
+ *
+ * @return Waiter.
+ */
+static struct completion_waiter *waiter_acquire(void)
+{
+    struct completion_waiter *waiter = NULL;
+
+    system_critical_section_enter();
+
+    for (size_t i = 0; (i < COMPLETION_SIM_MAX_WAITERS) && (waiter == NULL); i++) {
+        if (!waiters[i].used) {
+            waiter = &waiters[i];
+            waiter->used = true;
+        }
+    }
+
+    system_critical_section_exit();
+
+    RUNTIME_ASSERT(waiter != NULL);
+
+    if (!waiter->initialized) {
+        waiter->continuation = (struct completion_continuation) COMPLETION_CONTINUATION_INITIALIZER(0, wake_waiter);
+
+        int ret = sem_init(&waiter->semaphore, 0, 0);
+        RUNTIME_ASSERT(ret == 0);
+
+        waiter->initialized = true;
+    }
+
+    return waiter;
+}
+
+/**
+ * Returns a waiter once its thread was woken up.
+ *
+ * @param waiter Waiter.
+ */
+static void waiter_release(struct completion_waiter *waiter)
+{
+    system_critical_section_enter();
+    waiter->used = false;
+    system_critical_section_exit();
+}
+
+/**
+ * Work handler of the continuation which posts the semaphore of the waiting thread.
+ *
+ * @param work Work item of the continuation.
+ */
+static void wake_waiter(struct work *work)
+{
+    struct completion_waiter *waiter = CONTAINER_OF(work, struct completion_waiter, continuation.work);
+
+    int ret = sem_post(&waiter->semaphore);
+    RUNTIME_ASSERT(ret == 0);
+}
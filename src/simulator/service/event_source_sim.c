@@ -0,0 +1,189 @@
+#include <service/event_source_sim.h>
+#include <service/system.h>
+#include <service/assert.h>
+
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+#define MAX_EVENTS    16
+
+static void ms_to_timespec(u32_ms_t ms, struct timespec *ts);
+
+static int epoll_fd = -1;
+
+// signalled by other threads to end event_source_wait(), at most once until the waiting thread read it
+static int notify_fd = -1;
+static bool_t notify_pending;
+static _Thread_local bool_t waiting_thread;
+
+void event_source_setup(void)
+{
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    RUNTIME_ASSERT(epoll_fd >= 0);
+
+    notify_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    RUNTIME_ASSERT(notify_fd >= 0);
+
+    // the notification is the only event without a source
+    struct epoll_event event = {
+        .events = EPOLLIN,
+        .data.ptr = NULL,
+    };
+
+    int ret = epoll_ctl(epoll_fd, EPOLL_CTL_ADD, notify_fd, &event);
+    RUNTIME_ASSERT(ret == 0);
+}
+
+void event_source_add(struct event_source *source, int fd, uint32_t events)
+{
+    RUNTIME_ASSERT(source->fd < 0);
+
+    struct epoll_event event = {
+        .events = events,
+        .data.ptr = source,
+    };
+
+    source->fd = fd;
+    source->ready = 0;
+
+    int ret = epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    RUNTIME_ASSERT(ret == 0);
+}
+
+void event_source_remove(struct event_source *source)
+{
+    if (source->fd < 0) {
+        return;
+    }
+
+    int ret = epoll_ctl(epoll_fd, EPOLL_CTL_DEL, source->fd, NULL);
+    RUNTIME_ASSERT(ret == 0);
+
+    source->fd = -1;
+}
+
+uint32_t event_source_ready(struct event_source *source)
+{
+    system_critical_section_enter();
+
+    uint32_t ready = source->ready;
+    source->ready = 0;
+
+    system_critical_section_exit();
+
+    return ready;
+}
+
+void event_source_timer_start(struct event_source *source, u32_ms_t delay, u32_ms_t period)
+{
+    if (source->fd < 0) {
+        int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        RUNTIME_ASSERT(fd >= 0);
+
+        event_source_add(source, fd, EPOLLIN);
+    }
+
+    struct itimerspec spec;
+    ms_to_timespec(delay, &spec.it_value);
+    ms_to_timespec(period, &spec.it_interval);
+
+    // a zero value would disarm the timer
+    if (delay == 0) {
+        spec.it_value.tv_nsec = 1;
+    }
+
+    int ret = timerfd_settime(source->fd, 0, &spec, NULL);
+    RUNTIME_ASSERT(ret == 0);
+}
+
+void event_source_timer_stop(struct event_source *source)
+{
+    struct itimerspec spec = {0};
+
+    int ret = timerfd_settime(source->fd, 0, &spec, NULL);
+    RUNTIME_ASSERT(ret == 0);
+
+    // discard expirations which were not read yet
+    event_source_timer_read(source);
+}
+
+uint64_t event_source_timer_read(struct event_source *source)
+{
+    uint64_t expirations = 0;
+
+    if (read(source->fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+        RUNTIME_ASSERT(errno == EAGAIN);
+        return 0;
+    }
+
+    return expirations;
+}
+
+void event_source_notify(void)
+{
+    // the waiting thread checks for changes before it waits again anyway
+    if (waiting_thread || (notify_fd < 0)) {
+        return;
+    }
+
+    if (!__atomic_exchange_n(&notify_pending, true, __ATOMIC_ACQ_REL)) {
+        uint64_t value = 1;
+        ssize_t ret = write(notify_fd, &value, sizeof(value));
+        RUNTIME_ASSERT(ret == sizeof(value));
+    }
+}
+
+void event_source_wait(u64_us_t timeout)
+{
+    struct epoll_event events[MAX_EVENTS];
+    int timeout_ms = -1;
+
+    waiting_thread = true;
+
+    // round up to not wake up before the next scheduled item is ready
+    if (timeout != EVENT_SOURCE_WAIT_INFINITE) {
+        u64_us_t ms = (timeout + 999) / 1000;
+        timeout_ms = (ms < INT_MAX) ? (int) ms : INT_MAX;
+    }
+
+    int count = epoll_wait(epoll_fd, events, MAX_EVENTS, timeout_ms);
+
+    if (count < 0) {
+        RUNTIME_ASSERT(errno == EINTR);
+        return;
+    }
+
+    for (int i = 0; i < count; i++) {
+        struct event_source *source = events[i].data.ptr;
+
+        // another thread changed the state, the caller checks what has to be done
+        if (source == NULL) {
+            uint64_t value;
+
+            __atomic_store_n(&notify_pending, false, __ATOMIC_RELEASE);
+            RUNTIME_ASSERT((read(notify_fd, &value, sizeof(value)) == sizeof(value)) || (errno == EAGAIN));
+            continue;
+        }
+
+        system_critical_section_enter();
+        source->ready |= events[i].events;
+        work_submit(source->work);
+        system_critical_section_exit();
+    }
+}
+
+/**
+ * Helper function to convert milliseconds into a timespec.
+ *
+ * @param ms Milliseconds.
+ * @param ts Timespec to set.
+ */
+static void ms_to_timespec(u32_ms_t ms, struct timespec *ts)
+{
+    ts->tv_sec = (time_t) (ms / 1000);
+    ts->tv_nsec = (long) (ms % 1000) * 1000000;
+}
@@ -0,0 +1,159 @@
+#include <service/log_backend_sim.h>
+#include <service/event_source_sim.h>
+#include <service/work.h>
+#include <service/assert.h>
+#include <util/unused.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#define LOG_BACKEND_SIM_BUFFER_SIZE    4096
+#define LOG_BACKEND_SIM_PRIORITY       10
+
+static void transmit(struct log_backend *backend, const uint8_t *data, size_t length);
+static size_t panic(struct log_backend *backend);
+static void written_handler(struct work *work);
+static void wait_written(void);
+static void *writer_thread(void *arg);
+
+static const struct log_backend_api api = {
+    .transmit = transmit,
+    .panic = panic,
+};
+
+static const uint8_t *chunk_data;
+static size_t chunk_length;
+static sem_t chunk_semaphore;
+static int written_fd = -1;
+
+LOG_BACKEND_DEFINE(log_backend_sim, &api, LOG_BACKEND_SIM_BUFFER_SIZE, LOG_LEVEL_DBG);
+
+WORK_DEFINE(written_work, LOG_BACKEND_SIM_PRIORITY, written_handler);
+EVENT_SOURCE_DEFINE(written_source, &written_work);
+
+void log_backend_sim_setup(void)
+{
+    int ret = sem_init(&chunk_semaphore, 0, 0);
+    RUNTIME_ASSERT(ret == 0);
+
+    written_fd = eventfd(0, 0);
+    RUNTIME_ASSERT(written_fd >= 0);
+
+    event_source_add(&written_source, written_fd, EPOLLIN);
+
+    pthread_t thread;
+
+    ret = pthread_create(&thread, NULL, writer_thread, NULL);
+    RUNTIME_ASSERT(ret == 0);
+
+    ret = pthread_detach(thread);
+    RUNTIME_ASSERT(ret == 0);
+
+    log_backend_register(&log_backend_sim);
+}
+
+/**
+ * Hands a chunk to the writer thread.
+ *
+ * @param backend Backend.
+ * @param data Data to write.
+ * @param length Length of the data in bytes.
+ */
+static void transmit(struct log_backend *backend, const uint8_t *data, size_t length)
+{
+    ARG_UNUSED(backend);
+
+    chunk_data = data;
+    chunk_length = length;
+
+    int ret = sem_post(&chunk_semaphore);
+    RUNTIME_ASSERT(ret == 0);
+}
+
+/**
+ * Waits until the writer thread has written the ongoing chunk.
+ *
+ * @param backend Backend.
+ * @return Length of the chunk.
+ */
+static size_t panic(struct log_backend *backend)
+{
+    ARG_UNUSED(backend);
+
+    // writing does not depend on the work queue, so the writer thread always finishes
+    event_source_remove(&written_source);
+    wait_written();
+
+    return chunk_length;
+}
+
+/**
+ * Work handler reporting a written chunk to the log.
+ *
+ * @param work Work item.
+ */
+static void written_handler(struct work *work)
+{
+    ARG_UNUSED(work);
+
+    event_source_ready(&written_source);
+
+    // the signal was already consumed by `panic()`
+    if (log_backend_sim.panic) {
+        return;
+    }
+
+    wait_written();
+
+    log_backend_transmit_done(&log_backend_sim);
+}
+
+/**
+ * Blocks until the writer thread has signaled a written chunk and clears the signal.
+ */
+static void wait_written(void)
+{
+    uint64_t count;
+    ssize_t ret;
+
+    do {
+        ret = read(written_fd, &count, sizeof(count));
+    } while ((ret < 0) && (errno == EINTR));
+
+    RUNTIME_ASSERT(ret == sizeof(count));
+}
+
+/**
+ * Thread writing chunks to stdout.
+ *
+ * @param arg Unused.
+ * @return Unused.
+ */
+static void *writer_thread(void *arg)
+{
+    ARG_UNUSED(arg);
+
+    while (true) {
+        int ret;
+
+        do {
+            ret = sem_wait(&chunk_semaphore);
+        } while ((ret != 0) && (errno == EINTR));
+
+        RUNTIME_ASSERT(ret == 0);
+
+        fwrite(chunk_data, 1, chunk_length, stdout);
+        fflush(stdout);
+
+        uint64_t count = 1;
+        ssize_t written = write(written_fd, &count, sizeof(count));
+        RUNTIME_ASSERT(written == sizeof(count));
+    }
+
+    return NULL;
+}
@@ -0,0 +1,90 @@
+#include <service/pipeline_sim.h>
+#include <service/assert.h>
+#include <util/container_of.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+/**
+ * Stage processed by a dedicated thread.
+ */
+struct pinned_stage {
+    struct pipeline_stage *stage;
+    sem_t semaphore;
+};
+
+static void pinned_stage_handler(struct work *work);
+static void *thread_main(void *arg);
+
+static struct pinned_stage pinned_stages[PIPELINE_SIM_MAX_THREADS];
+static size_t pinned_count;
+
+void pipeline_stage_pin_thread(struct pipeline_stage *stage)
+{
+    RUNTIME_ASSERT(pinned_count < PIPELINE_SIM_MAX_THREADS);
+
+    struct pinned_stage *pinned = &pinned_stages[pinned_count];
+    pinned->stage = stage;
+
+    int ret = sem_init(&pinned->semaphore, 0, 0);
+    RUNTIME_ASSERT(ret == 0);
+
+    pinned_count++;
+    stage->work.handler = pinned_stage_handler;
+
+    pthread_t thread;
+
+    ret = pthread_create(&thread, NULL, thread_main, pinned);
+    RUNTIME_ASSERT(ret == 0);
+
+    ret = pthread_detach(thread);
+    RUNTIME_ASSERT(ret == 0);
+}
+
+/**
+ * Work handler of pinned stages which wakes up the thread of the stage.
+ *
+ * @param work Work item of the stage.
+ */
+static void pinned_stage_handler(struct work *work)
+{
+    struct pipeline_stage *stage = CONTAINER_OF(work, struct pipeline_stage, work);
+
+    for (size_t i = 0; i < pinned_count; i++) {
+        if (pinned_stages[i].stage == stage) {
+            int ret = sem_post(&pinned_stages[i].semaphore);
+            RUNTIME_ASSERT(ret == 0);
+            return;
+        }
+    }
+
+    RUNTIME_ASSERT(false);
+}
+
+/**
+ * Thread processing the blocks of a pinned stage.
+ *
+ * @param arg Pinned stage.
+ * @return Unused.
+ */
+static void *thread_main(void *arg)
+{
+    struct pinned_stage *pinned = arg;
+
+    while (true) {
+        int ret;
+
+        do {
+            ret = sem_wait(&pinned->semaphore);
+        } while ((ret != 0) && (errno == EINTR));
+
+        RUNTIME_ASSERT(ret == 0);
+
+        while (pipeline_stage_process(pinned->stage)) {
+            // process all available blocks
+        }
+    }
+
+    return NULL;
+}
@@ -1,57 +1,135 @@
 #include <service/system_sim.h>
 #include <service/assert.h>
 #include <service/log.h>
+#include <service/work.h>
+#include <service/event_source_sim.h>
+#include <util/unused.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <time.h>
 #include <stdio.h>
 #include <pthread.h>
 
+// latencies are nominal, the simulator sleeps the same way in both states
+static const struct system_sleep_state sleep_states[] = {
+    {"sleep", 0, 0, 0},
+    {"deep_sleep", 100, 1000, 10000},
+};
+
 static i64_us_t uptime_delta;
 static u64_us_t scheduled_wakeup;
 
 static pthread_mutex_t critical_section_mutex;
+// nesting depth of the thread owning the critical section
+static size_t critical_section_depth;
+
+// simulated wake-up timer
+static pthread_t wakeup_thread;
+static pthread_mutex_t wakeup_mutex;
+static pthread_cond_t wakeup_cond;
 
 static u64_us_t clock_raw_get(void);
+static void *wakeup_thread_main(void *arg);
 
 void system_setup(void)
 {
     uptime_delta = (i64_us_t) clock_raw_get();
 
+    event_source_setup();
+
     pthread_mutexattr_t attr;
     pthread_mutexattr_init(&attr);
     pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
 
     int ret = pthread_mutex_init(&critical_section_mutex, &attr);
     RUNTIME_ASSERT(ret == 0);
+
+    pthread_condattr_t cond_attr;
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+
+    ret = pthread_mutex_init(&wakeup_mutex, NULL);
+    RUNTIME_ASSERT(ret == 0);
+
+    ret = pthread_cond_init(&wakeup_cond, &cond_attr);
+    RUNTIME_ASSERT(ret == 0);
+
+    ret = pthread_create(&wakeup_thread, NULL, wakeup_thread_main, NULL);
+    RUNTIME_ASSERT(ret == 0);
 }
 
 void system_critical_section_enter(void)
 {
     int ret = pthread_mutex_lock(&critical_section_mutex);
     RUNTIME_ASSERT(ret == 0);
+
+    critical_section_depth++;
 }
 
 void system_critical_section_exit(void)
 {
+    bool_t outermost = (--critical_section_depth == 0);
+
     int ret = pthread_mutex_unlock(&critical_section_mutex);
     RUNTIME_ASSERT(ret == 0);
+
+    // other threads may have submitted work or scheduled a wake-up, like an interrupt ends the sleep mode
+    if (outermost) {
+        event_source_notify();
+    }
 }
 
-void system_wakeup_schedule_at(u64_ms_t uptime)
+void system_wakeup_schedule_at(u64_tick_t uptime)
 {
-    scheduled_wakeup = uptime * 1000;
+    pthread_mutex_lock(&wakeup_mutex);
+
+    // zero is reserved for no scheduled wake-up
+    scheduled_wakeup = (uptime > 0) ? SYSTEM_TICKS_TO_US(uptime) : 1;
+
+    pthread_cond_broadcast(&wakeup_cond);
+    pthread_mutex_unlock(&wakeup_mutex);
 }
 
-void system_enter_sleep_mode(void)
+void system_enter_sleep_mode(size_t state)
 {
-    u64_us_t current_uptime = system_uptime_get_us();
+    RUNTIME_ASSERT(state < sizeof(sleep_states) / sizeof(sleep_states[0]));
+
+    pthread_mutex_lock(&wakeup_mutex);
+    u64_us_t wakeup = scheduled_wakeup;
+    pthread_mutex_unlock(&wakeup_mutex);
+
+    u64_us_t timeout = EVENT_SOURCE_WAIT_INFINITE;
+
+    // an expired wake-up was already taken by the wake-up thread, which notifies us once it ran the timer items
+    if (wakeup != 0) {
+        u64_us_t current_uptime = system_uptime_get_us();
+        timeout = (wakeup > current_uptime) ? (wakeup - current_uptime) : 0;
+    }
+
+    // pending interrupts end the sleep mode of the target although they are masked, so release the critical
+    // section for the other threads while waiting, each of them leaving it again ends the wait
+    size_t depth = critical_section_depth;
+    critical_section_depth = 0;
+
+    for (size_t i = 0; i < depth; i++) {
+        int ret = pthread_mutex_unlock(&critical_section_mutex);
+        RUNTIME_ASSERT(ret == 0);
+    }
 
-    if (current_uptime < scheduled_wakeup) {
-        usleep(scheduled_wakeup - current_uptime);
+    event_source_wait(timeout);
+
+    for (size_t i = 0; i < depth; i++) {
+        int ret = pthread_mutex_lock(&critical_section_mutex);
+        RUNTIME_ASSERT(ret == 0);
     }
 
-    scheduled_wakeup = 0;
+    critical_section_depth = depth;
+}
+
+size_t system_sleep_states_get(const struct system_sleep_state **states)
+{
+    *states = sleep_states;
+    return sizeof(sleep_states) / sizeof(sleep_states[0]);
 }
 
 u64_us_t system_uptime_get_us(void)
@@ -59,6 +137,11 @@ u64_us_t system_uptime_get_us(void)
     return clock_raw_get() - uptime_delta;
 }
 
+u64_tick_t system_uptime_get_ticks(void)
+{
+    return SYSTEM_US_TO_TICKS(system_uptime_get_us());
+}
+
 u64_ms_t system_uptime_get_ms(void)
 {
     return system_uptime_get_us() / 1000;
@@ -91,3 +174,55 @@ static u64_us_t clock_raw_get(void)
     clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
     return (ts.tv_nsec / 1000ULL) + (ts.tv_sec * 1000000ULL);
 }
+
+/**
+ * Simulates the wake-up timer interrupt.
+ *
+ * Waits until the scheduled wake-up expires and executes the timer items while holding the critical section
+ * like an ISR would. Leaving the critical section ends the sleep of the work queue thread.
+ */
+static void *wakeup_thread_main(void *arg)
+{
+    ARG_UNUSED(arg);
+
+    pthread_mutex_lock(&wakeup_mutex);
+
+    while (true) {
+        if (scheduled_wakeup == 0) {
+            pthread_cond_wait(&wakeup_cond, &wakeup_mutex);
+            continue;
+        }
+
+        u64_us_t current_uptime = system_uptime_get_us();
+
+        if (current_uptime < scheduled_wakeup) {
+            // convert the uptime, which is based on the raw clock, into a timeout of the condition clock
+            u64_us_t delay = scheduled_wakeup - current_uptime;
+            struct timespec timeout;
+            clock_gettime(CLOCK_MONOTONIC, &timeout);
+
+            timeout.tv_sec += (time_t) (delay / 1000000);
+            timeout.tv_nsec += (long) (delay % 1000000) * 1000;
+
+            if (timeout.tv_nsec >= 1000000000) {
+                timeout.tv_sec++;
+                timeout.tv_nsec -= 1000000000;
+            }
+
+            pthread_cond_timedwait(&wakeup_cond, &wakeup_mutex, &timeout);
+            continue;
+        }
+
+        scheduled_wakeup = 0;
+
+        pthread_mutex_unlock(&wakeup_mutex);
+
+        system_critical_section_enter();
+        work_wakeup_handler();
+        system_critical_section_exit();
+
+        pthread_mutex_lock(&wakeup_mutex);
+    }
+
+    return NULL;
+}
@@ -0,0 +1,88 @@
+#include <service/log_backend_fake.h>
+#include <service/system.h>
+#include <util/unused.h>
+
+#define LOG_BACKEND_FAKE_BUFFER_SIZE    512
+
+static void transmit(struct log_backend *backend, const uint8_t *data, size_t length);
+static size_t panic(struct log_backend *backend);
+
+static const struct log_backend_api api = {
+    .transmit = transmit,
+    .panic = panic,
+};
+
+static const uint8_t *pending_data;
+static size_t pending_length;
+static bool_t complete_immediately;
+
+LOG_BACKEND_DEFINE(log_backend_fake, &api, LOG_BACKEND_FAKE_BUFFER_SIZE, LOG_LEVEL_DBG);
+
+void log_backend_fake_reset(bool_t auto_complete)
+{
+    log_backend_fake_buffer.read = 0;
+    log_backend_fake_buffer.write = 0;
+    log_backend_fake.transmitting = 0;
+    log_backend_fake.panic = false;
+    log_backend_set_level(&log_backend_fake, LOG_LEVEL_DBG);
+
+    pending_data = NULL;
+    pending_length = 0;
+    complete_immediately = auto_complete;
+}
+
+size_t log_backend_fake_pending(void)
+{
+    return pending_length;
+}
+
+void log_backend_fake_complete(void)
+{
+    const uint8_t *data = pending_data;
+    size_t length = pending_length;
+
+    pending_data = NULL;
+    pending_length = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        system_debug_out((char) data[i]);
+    }
+
+    log_backend_transmit_done(&log_backend_fake);
+}
+
+/**
+ * Records the chunk and completes it immediately if requested.
+ *
+ * @param backend Backend.
+ * @param data Data to transmit.
+ * @param length Length of the data in bytes.
+ */
+static void transmit(struct log_backend *backend, const uint8_t *data, size_t length)
+{
+    ARG_UNUSED(backend);
+
+    pending_data = data;
+    pending_length = length;
+
+    if (complete_immediately) {
+        log_backend_fake_complete();
+    }
+}
+
+/**
+ * Drops the pending chunk, it is written synchronously by the log instead.
+ *
+ * @param backend Backend.
+ * @return Always zero.
+ */
+static size_t panic(struct log_backend *backend)
+{
+    ARG_UNUSED(backend);
+
+    // nothing of the pending chunk has been written yet
+    pending_data = NULL;
+    pending_length = 0;
+
+    return 0;
+}
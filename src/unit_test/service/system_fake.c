@@ -1,9 +1,18 @@
 #include <service/assert.h>
 #include <service/system.h>
 #include <service/unit_test.h>
+#include <service/system_fake.h>
+#include <service/work.h>
+
+static const struct system_sleep_state sleep_states[] = {
+    [SYSTEM_FAKE_SLEEP] = {"sleep", 0, 0, 0},
+    [SYSTEM_FAKE_STOP] = {"stop", 50, 100, 1000},
+    [SYSTEM_FAKE_STANDBY] = {"standby", 1000, 5000, 100000},
+};
 
 static u64_us_t uptime_counter;
-static u64_us_t scheduled_wakeup;
+static u64_tick_t scheduled_wakeup;
+static size_t last_sleep_state;
 
 void system_critical_section_enter(void)
 {
@@ -15,16 +24,32 @@ void system_critical_section_exit(void)
     // do nothing
 }
 
-void system_wakeup_schedule_at(u64_ms_t uptime)
+void system_wakeup_schedule_at(u64_tick_t uptime)
 {
-    scheduled_wakeup = uptime * 1000;
+    scheduled_wakeup = uptime;
 }
 
-void system_enter_sleep_mode(void)
+void system_enter_sleep_mode(size_t state)
 {
+    RUNTIME_ASSERT(state < sizeof(sleep_states) / sizeof(sleep_states[0]));
     RUNTIME_ASSERT(scheduled_wakeup != 0);
-    uptime_counter = scheduled_wakeup;
+    last_sleep_state = state;
+    uptime_counter = SYSTEM_TICKS_TO_US(scheduled_wakeup);
     scheduled_wakeup = 0;
+
+    // wake-up timer interrupt
+    work_wakeup_handler();
+}
+
+size_t system_sleep_states_get(const struct system_sleep_state **states)
+{
+    *states = sleep_states;
+    return sizeof(sleep_states) / sizeof(sleep_states[0]);
+}
+
+size_t system_fake_last_sleep_state(void)
+{
+    return last_sleep_state;
 }
 
 u64_us_t system_uptime_get_us(void)
@@ -32,6 +57,11 @@ u64_us_t system_uptime_get_us(void)
     return uptime_counter;
 }
 
+u64_tick_t system_uptime_get_ticks(void)
+{
+    return SYSTEM_US_TO_TICKS(uptime_counter);
+}
+
 u64_ms_t system_uptime_get_ms(void)
 {
     return uptime_counter / 1000;
@@ -66,7 +96,19 @@ void system_busy_sleep_ms(u64_ms_t delay)
 
 void system_busy_sleep_us(u64_us_t delay)
 {
-    uptime_counter += delay;
+    u64_us_t until = uptime_counter + delay;
+
+    // wake-up timer interrupts expiring while busy
+    while ((scheduled_wakeup != 0) && (SYSTEM_TICKS_TO_US(scheduled_wakeup) <= until)) {
+        if (SYSTEM_TICKS_TO_US(scheduled_wakeup) > uptime_counter) {
+            uptime_counter = SYSTEM_TICKS_TO_US(scheduled_wakeup);
+        }
+
+        scheduled_wakeup = 0;
+        work_wakeup_handler();
+    }
+
+    uptime_counter = until;
 }
 
 void system_fatal_error(void)
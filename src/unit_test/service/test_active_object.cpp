@@ -0,0 +1,132 @@
+#include <service/unit_test.h>
+#include <service/active_object.h>
+#include <service/system.h>
+#include <vector>
+
+enum {
+    STATE_IDLE,
+    STATE_RUNNING,
+    STATE_COUNT,
+};
+
+enum {
+    SIGNAL_START,
+    SIGNAL_STOP,
+    SIGNAL_TIMEOUT,
+};
+
+static std::vector<uint32_t> s_signals;
+static std::vector<u64_ms_t> s_timeouts;
+
+extern const struct hsm_state s_states[STATE_COUNT];
+extern struct active_object_timer s_timer;
+
+static enum hsm_result idle_handler(struct hsm *hsm, const struct hsm_event *event)
+{
+    s_signals.push_back(event->signal);
+
+    if (event->signal == SIGNAL_START) {
+        return hsm_transition(hsm, &s_states[STATE_RUNNING]);
+    }
+
+    return HSM_HANDLED;
+}
+
+static void running_entry(struct hsm *)
+{
+    active_object_timer_start(&s_timer, 100);
+}
+
+static void running_exit(struct hsm *)
+{
+    active_object_timer_stop(&s_timer);
+}
+
+static enum hsm_result running_handler(struct hsm *hsm, const struct hsm_event *event)
+{
+    s_signals.push_back(event->signal);
+
+    switch (event->signal) {
+        case SIGNAL_STOP:
+            return hsm_transition(hsm, &s_states[STATE_IDLE]);
+
+        case SIGNAL_TIMEOUT:
+            s_timeouts.push_back(system_uptime_get_ms());
+            active_object_timer_start(&s_timer, 100);
+            return HSM_HANDLED;
+
+        default:
+            return HSM_HANDLED;
+    }
+}
+
+const struct hsm_state s_states[STATE_COUNT] = {
+    { "idle", NULL, NULL, NULL, NULL, idle_handler },
+    { "running", NULL, NULL, running_entry, running_exit, running_handler },
+};
+
+ACTIVE_OBJECT_DEFINE(s_object, 0, s_states, &s_states[STATE_IDLE], 4);
+ACTIVE_OBJECT_TIMER_DEFINE(s_timer, 0, &s_object, SIGNAL_TIMEOUT, 0);
+
+TEST_GROUP(active_object) {
+    void setup() override
+    {
+        active_object_start(&s_object);
+        work_run_for(0);
+        s_signals.clear();
+        s_timeouts.clear();
+    }
+
+    void teardown() override
+    {
+        active_object_post(&s_object, SIGNAL_STOP, 0);
+        work_run_for(0);
+        work_cancel(&s_object.work);
+    }
+};
+
+TEST(active_object, dispatch_in_order)
+{
+    CHECK_TRUE(active_object_post(&s_object, SIGNAL_STOP, 0));
+    CHECK_TRUE(active_object_post(&s_object, SIGNAL_START, 0));
+    CHECK_TRUE(active_object_post(&s_object, SIGNAL_STOP, 0));
+    CHECK_TRUE(s_signals.empty());
+
+    work_run_for(0);
+    CHECK_TRUE((std::vector<uint32_t>{ SIGNAL_STOP, SIGNAL_START, SIGNAL_STOP }) == s_signals);
+    POINTERS_EQUAL(&s_states[STATE_IDLE], s_object.hsm.current);
+}
+
+TEST(active_object, queue_full)
+{
+    for (int i = 0; i < 4; i++) {
+        CHECK_TRUE(active_object_post(&s_object, SIGNAL_STOP, 0));
+    }
+
+    CHECK_FALSE(active_object_post(&s_object, SIGNAL_STOP, 0));
+
+    work_run_for(0);
+    CHECK_EQUAL(4, s_signals.size());
+}
+
+TEST(active_object, timer)
+{
+    u64_ms_t start = system_uptime_get_ms();
+
+    active_object_post(&s_object, SIGNAL_START, 0);
+    work_run_for(350);
+
+    CHECK_TRUE((std::vector<u64_ms_t>{ start + 100, start + 200, start + 300 }) == s_timeouts);
+}
+
+TEST(active_object, timer_stopped_on_exit)
+{
+    active_object_post(&s_object, SIGNAL_START, 0);
+    work_run_for(150);
+
+    active_object_post(&s_object, SIGNAL_STOP, 0);
+    work_run_for(500);
+
+    CHECK_EQUAL(1, s_timeouts.size());
+    POINTERS_EQUAL(&s_states[STATE_IDLE], s_object.hsm.current);
+}
@@ -0,0 +1,129 @@
+#include <service/unit_test.h>
+#include <service/bus.h>
+#include <service/system.h>
+#include <util/unused.h>
+#include <vector>
+
+struct sample {
+    int32_t value;
+    uint32_t channel;
+};
+
+BUS_TOPIC_DEFINE(samples, struct sample);
+
+static std::vector<int32_t> s_work_values;
+static std::vector<int32_t> s_callback_values;
+static std::vector<uint32_t> s_sequences;
+
+static void sample_handler(struct work *work)
+{
+    ARG_UNUSED(work);
+
+    struct sample sample;
+    s_sequences.push_back(BUS_READ(samples, &sample));
+    s_work_values.push_back(sample.value);
+}
+
+static void sample_callback(const struct bus_topic *topic, const void *message)
+{
+    CHECK_EQUAL(&samples, topic);
+    s_callback_values.push_back(static_cast<const struct sample *>(message)->value);
+}
+
+static WORK_DEFINE(sample_work, 0, sample_handler);
+static struct bus_subscriber work_subscriber = BUS_SUBSCRIBER_WORK_INITIALIZER(&sample_work);
+static struct bus_subscriber callback_subscriber = BUS_SUBSCRIBER_CALLBACK_INITIALIZER(sample_callback);
+
+TEST_GROUP(bus) {
+    void setup() override
+    {
+        s_work_values.clear();
+        s_callback_values.clear();
+        s_sequences.clear();
+
+        samples.subscribers = NULL;
+        bus_subscribe(&samples, &work_subscriber);
+        bus_subscribe(&samples, &callback_subscriber);
+
+        struct bus_topic_stats stats;
+        bus_stats_read(&samples, &stats);
+    }
+};
+
+TEST(bus, publish)
+{
+    struct sample sample = { 42, 1 };
+    BUS_PUBLISH(samples, &sample);
+
+    // callbacks are called immediately, work items later
+    CHECK_EQUAL(1, s_callback_values.size());
+    CHECK_EQUAL(42, s_callback_values[0]);
+    CHECK_EQUAL(0, s_work_values.size());
+
+    work_run_for(0);
+    CHECK_EQUAL(1, s_work_values.size());
+    CHECK_EQUAL(42, s_work_values[0]);
+}
+
+TEST(bus, latest_message_wins)
+{
+    uint32_t sequence_before = samples.sequence;
+
+    for (int32_t i = 0; i < 3; i++) {
+        struct sample sample = { i, 0 };
+        BUS_PUBLISH(samples, &sample);
+    }
+
+    work_run_for(0);
+
+    std::vector<int32_t> expected_callback = { 0, 1, 2 };
+    CHECK_TRUE(expected_callback == s_callback_values);
+
+    // work subscriber is only submitted once and sees the latest message
+    CHECK_EQUAL(1, s_work_values.size());
+    CHECK_EQUAL(2, s_work_values[0]);
+    CHECK_EQUAL(sequence_before + 3, s_sequences[0]);
+}
+
+TEST(bus, publish_rate)
+{
+    struct sample sample = { 0, 0 };
+
+    for (int i = 0; i < 50; i++) {
+        BUS_PUBLISH(samples, &sample);
+        system_busy_sleep_ms(10);
+    }
+
+    struct bus_topic_stats stats;
+    u64_us_t now = system_uptime_get_us();
+    bus_stats_read(&samples, &stats);
+
+    CHECK_EQUAL(50, stats.publish_count);
+    CHECK_EQUAL(100, bus_stats_publish_rate(&stats, now));
+
+    // statistics are reset after reading
+    bus_stats_read(&samples, &stats);
+    CHECK_EQUAL(0, stats.publish_count);
+
+    work_run_for(0);
+}
+
+TEST(bus, latency)
+{
+    struct sample sample = { 0, 0 };
+
+    BUS_PUBLISH(samples, &sample);
+    system_busy_sleep_us(300);
+    work_run_for(0);
+
+    BUS_PUBLISH(samples, &sample);
+    system_busy_sleep_us(100);
+    work_run_for(0);
+
+    struct bus_topic_stats stats;
+    bus_stats_read(&samples, &stats);
+
+    CHECK_EQUAL(2, stats.latency_count);
+    CHECK_EQUAL(300, stats.latency_max);
+    CHECK_EQUAL(400, stats.latency_sum);
+}
@@ -9,7 +9,7 @@ static void check_format(const char *format, auto... args)
         static_cast<std::string *>(ctx)->append(1, c);
     };
 
-    std::string actual_direct, actual_captured;
+    std::string actual_direct, actual_captured, actual_static;
     uint8_t buffer[256];
     char expected[256];
 
@@ -28,6 +28,14 @@ static void check_format(const char *format, auto... args)
 
     cbprintf_restore(string_appender, &actual_captured, buffer, length);
     CHECK_EQUAL(std::string(expected), actual_captured);
+
+    // check static package, which has the same layout as the captured one
+    CBPRINTF_STATIC_PACKAGE(package, format, args...);
+    CHECK_EQUAL(length, sizeof(package));
+    MEMCMP_EQUAL(buffer, &package, length);
+
+    cbprintf_restore(string_appender, &actual_static, &package, sizeof(package));
+    CHECK_EQUAL(std::string(expected), actual_static);
 }
 
 TEST_GROUP(cbprintf) {
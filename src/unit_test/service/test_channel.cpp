@@ -0,0 +1,190 @@
+#include <service/unit_test.h>
+#include <service/channel.h>
+#include <util/unused.h>
+#include <vector>
+
+struct sample {
+    uint32_t value;
+    uint16_t channel;
+};
+
+static void consumer_handler(struct work *work);
+
+static WORK_DEFINE(consumer, 0, consumer_handler);
+static std::vector<uint32_t> s_received;
+
+CHANNEL_DEFINE(spsc, CHANNEL_SPSC, struct sample, 4, NULL);
+CHANNEL_DEFINE(mpsc, CHANNEL_MPSC, struct sample, 4, NULL);
+CHANNEL_DEFINE(consumed, CHANNEL_MPSC, uint32_t, 8, &consumer);
+
+static void consumer_handler(struct work *work)
+{
+    ARG_UNUSED(work);
+
+    uint32_t value;
+
+    while (channel_receive(&consumed, &value)) {
+        s_received.push_back(value);
+    }
+}
+
+static void drain(struct channel *channel)
+{
+    while (channel_peek(channel) != NULL) {
+        channel_release(channel);
+    }
+
+    channel->high_watermark = 0;
+    channel->overflows = 0;
+}
+
+TEST_GROUP(channel) {
+    void setup() override
+    {
+        s_received.clear();
+    }
+
+    void teardown() override
+    {
+        drain(&spsc);
+        drain(&mpsc);
+        drain(&consumed);
+        work_cancel(&consumer);
+    }
+};
+
+TEST(channel, send_receive)
+{
+    for (auto *channel: { &spsc, &mpsc }) {
+        struct sample sample;
+
+        CHECK_FALSE(channel_receive(channel, &sample));
+
+        for (uint32_t i = 0; i < 3; i++) {
+            sample = { i, 0 };
+            CHECK_TRUE(channel_send(channel, &sample));
+        }
+
+        for (uint32_t i = 0; i < 3; i++) {
+            CHECK_TRUE(channel_receive(channel, &sample));
+            CHECK_EQUAL(i, sample.value);
+        }
+
+        CHECK_FALSE(channel_receive(channel, &sample));
+    }
+}
+
+TEST(channel, overflow)
+{
+    for (auto *channel: { &spsc, &mpsc }) {
+        struct sample sample = { 0, 0 };
+
+        for (uint32_t i = 0; i < 4; i++) {
+            CHECK_TRUE(channel_send(channel, &sample));
+        }
+
+        CHECK_FALSE(channel_send(channel, &sample));
+        CHECK_EQUAL(nullptr, channel_reserve(channel));
+        CHECK_EQUAL(2, channel->overflows);
+        CHECK_EQUAL(4, channel->high_watermark);
+
+        // space is available again after releasing
+        channel_release(channel);
+        CHECK_TRUE(channel_send(channel, &sample));
+    }
+}
+
+TEST(channel, high_watermark)
+{
+    for (auto *channel: { &spsc, &mpsc }) {
+        struct sample sample = { 0, 0 };
+
+        for (uint32_t i = 0; i < 10; i++) {
+            channel_send(channel, &sample);
+            channel_send(channel, &sample);
+            channel_receive(channel, &sample);
+            channel_receive(channel, &sample);
+        }
+
+        CHECK_EQUAL(2, channel->high_watermark);
+        CHECK_EQUAL(0, channel->overflows);
+    }
+}
+
+TEST(channel, zero_copy)
+{
+    for (auto *channel: { &spsc, &mpsc }) {
+        auto *reserved = static_cast<struct sample *>(channel_reserve(channel));
+        CHECK(reserved != nullptr);
+
+        reserved->value = 42;
+        reserved->channel = 7;
+
+        // reserved elements are not visible to the consumer
+        CHECK_EQUAL(nullptr, channel_peek(channel));
+
+        channel_commit(channel, reserved);
+
+        auto *peeked = static_cast<struct sample *>(channel_peek(channel));
+        CHECK_EQUAL(reserved, peeked);
+        CHECK_EQUAL(42, peeked->value);
+        CHECK_EQUAL(7, peeked->channel);
+
+        channel_release(channel);
+        CHECK_EQUAL(nullptr, channel_peek(channel));
+    }
+}
+
+TEST(channel, mpsc_commit_order)
+{
+    auto *first = static_cast<struct sample *>(channel_reserve(&mpsc));
+    auto *second = static_cast<struct sample *>(channel_reserve(&mpsc));
+
+    first->value = 1;
+    second->value = 2;
+
+    // a later reservation committed first waits for the earlier one
+    channel_commit(&mpsc, second);
+    CHECK_EQUAL(nullptr, channel_peek(&mpsc));
+
+    channel_commit(&mpsc, first);
+
+    struct sample sample;
+    CHECK_TRUE(channel_receive(&mpsc, &sample));
+    CHECK_EQUAL(1, sample.value);
+    CHECK_TRUE(channel_receive(&mpsc, &sample));
+    CHECK_EQUAL(2, sample.value);
+}
+
+TEST(channel, wraparound)
+{
+    for (auto *channel: { &spsc, &mpsc }) {
+        struct sample sample;
+
+        for (uint32_t i = 0; i < 100; i++) {
+            sample = { i, 0 };
+            CHECK_TRUE(channel_send(channel, &sample));
+
+            if ((i % 3) == 2) {
+                CHECK_TRUE(channel_receive(channel, &sample));
+                CHECK_TRUE(channel_receive(channel, &sample));
+                CHECK_TRUE(channel_receive(channel, &sample));
+                CHECK_EQUAL(i, sample.value);
+            }
+        }
+    }
+}
+
+TEST(channel, consumer_submitted)
+{
+    for (uint32_t i = 0; i < 5; i++) {
+        channel_send(&consumed, &i);
+    }
+
+    CHECK_TRUE(s_received.empty());
+
+    work_run_for(0);
+
+    std::vector<uint32_t> expected = { 0, 1, 2, 3, 4 };
+    CHECK_TRUE(expected == s_received);
+}
@@ -0,0 +1,100 @@
+#include <service/unit_test.h>
+#include <service/completion.h>
+#include <vector>
+
+static std::vector<struct work *> s_executed;
+
+static void record_handler(struct work *work)
+{
+    s_executed.push_back(work);
+}
+
+TEST_GROUP(completion) {
+    struct completion completion = COMPLETION_INITIALIZER();
+    struct completion_continuation first = COMPLETION_CONTINUATION_INITIALIZER(1, record_handler);
+    struct completion_continuation second = COMPLETION_CONTINUATION_INITIALIZER(1, record_handler);
+    struct completion_work job = COMPLETION_WORK_INITIALIZER(0, record_handler);
+
+    void setup() override
+    {
+        s_executed.clear();
+    }
+
+    void teardown() override
+    {
+        for (auto *continuation: { &first, &second }) {
+            completion_cancel(&completion, continuation);
+            completion_cancel(&job.completion, continuation);
+            work_cancel(&continuation->work);
+        }
+
+        work_cancel(&job.work);
+    }
+
+    void check(std::vector<struct work *> expected)
+    {
+        CHECK_TRUE(expected == s_executed);
+        s_executed.clear();
+    }
+};
+
+TEST(completion, continuations_in_order)
+{
+    completion_then(&completion, &second);
+    completion_then(&completion, &first);
+    work_run_for(0);
+    check({});
+
+    completion_complete(&completion);
+    CHECK_TRUE(completion_is_done(&completion));
+    work_run_for(0);
+    check({ &second.work, &first.work });
+
+    // continuations are one-shot
+    completion_reset(&completion);
+    completion_complete(&completion);
+    work_run_for(0);
+    check({});
+    CHECK_EQUAL(2, completion.count);
+}
+
+TEST(completion, then_after_done)
+{
+    completion_complete(&completion);
+    completion_then(&completion, &first);
+    work_run_for(0);
+    check({ &first.work });
+
+    completion_reset(&completion);
+    CHECK_FALSE(completion_is_done(&completion));
+}
+
+TEST(completion, cancel)
+{
+    completion_then(&completion, &first);
+    completion_then(&completion, &second);
+    completion_cancel(&completion, &first);
+
+    completion_complete(&completion);
+    work_run_for(0);
+    check({ &second.work });
+}
+
+TEST(completion, work_item)
+{
+    completion_work_submit(&job);
+    completion_then(&job.completion, &first);
+    CHECK_FALSE(completion_is_done(&job.completion));
+
+    // continuation runs after the handler returned, even with lower priority
+    work_run_for(0);
+    check({ &job.work, &first.work });
+    CHECK_TRUE(completion_is_done(&job.completion));
+
+    // submitting again resets the completion
+    completion_work_submit(&job);
+    CHECK_FALSE(completion_is_done(&job.completion));
+    work_run_for(0);
+    check({ &job.work });
+    CHECK_TRUE(completion_is_done(&job.completion));
+}
@@ -0,0 +1,113 @@
+#include <service/unit_test.h>
+#include <service/completion_sim.h>
+#include <service/system_sim.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#define WAIT_REPEATS    100
+#define WAIT_THREADS    3
+
+static std::atomic<unsigned> s_handled;
+static std::atomic<unsigned> s_returned;
+static unsigned s_returned_on_complete;
+
+static void count_handler(struct work *)
+{
+    s_handled++;
+}
+
+static COMPLETION_WORK_DEFINE(s_job, 1, count_handler);
+static struct completion s_completion = COMPLETION_INITIALIZER();
+
+static void complete_handler(struct work *)
+{
+    s_returned_on_complete = s_returned;
+    completion_complete(&s_completion);
+}
+
+static WORK_DEFINE(s_complete, 1, complete_handler);
+
+TEST_GROUP(completion_sim) {
+    void setup() override
+    {
+        static bool initialized;
+
+        // the simulated system lives until the test ends
+        if (!initialized) {
+            system_setup();
+            initialized = true;
+        }
+
+        completion_reset(&s_completion);
+        s_handled = 0;
+        s_returned = 0;
+        s_returned_on_complete = 0;
+    }
+
+    void join(std::vector<std::thread> &threads, unsigned expected)
+    {
+        // threads still waiting would block the test forever
+        if (s_returned != expected) {
+            completion_complete(&s_job.completion);
+            completion_complete(&s_completion);
+            work_run_for(100);
+        }
+
+        for (auto &thread: threads) {
+            thread.join();
+        }
+
+        CHECK_EQUAL(expected, s_returned.load());
+    }
+};
+
+TEST(completion_sim, already_done)
+{
+    completion_complete(&s_completion);
+
+    // returns without the work queue
+    completion_wait(&s_completion);
+}
+
+TEST(completion_sim, wait_for_work_repeatedly)
+{
+    std::vector<std::thread> threads;
+
+    threads.emplace_back([]() {
+        for (unsigned i = 0; i < WAIT_REPEATS; i++) {
+            completion_work_submit(&s_job);
+            completion_wait(&s_job.completion);
+
+            // every wait registers again and returns only after its own run of the work item
+            if (s_handled != i + 1) {
+                return;
+            }
+        }
+
+        s_returned++;
+    });
+
+    work_run_for(500);
+
+    join(threads, 1);
+    CHECK_EQUAL(WAIT_REPEATS, s_handled.load());
+}
+
+TEST(completion_sim, several_waiters)
+{
+    std::vector<std::thread> threads;
+
+    for (unsigned i = 0; i < WAIT_THREADS; i++) {
+        threads.emplace_back([]() {
+            completion_wait(&s_completion);
+            s_returned++;
+        });
+    }
+
+    work_schedule_after(&s_complete, 10);
+    work_run_for(200);
+
+    join(threads, WAIT_THREADS);
+    CHECK_EQUAL(0, s_returned_on_complete);
+}
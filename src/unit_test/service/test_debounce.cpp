@@ -0,0 +1,86 @@
+#include <service/unit_test.h>
+#include <service/debounce.h>
+#include <service/system.h>
+#include <util/unused.h>
+
+static uint32_t s_executions;
+static u64_ms_t s_last_execution;
+
+static void target_handler(struct work *work)
+{
+    ARG_UNUSED(work);
+
+    s_executions++;
+    s_last_execution = system_uptime_get_ms();
+}
+
+TEST_GROUP(debounce) {
+    struct work target = WORK_INITIALIZER(0, target_handler);
+    struct debounce debounce = DEBOUNCE_INITIALIZER(&target, 10);
+
+    void setup() override
+    {
+        s_executions = 0;
+        s_last_execution = 0;
+    }
+
+    void teardown() override
+    {
+        debounce_cancel(&debounce);
+        work_cancel(&target);
+    }
+};
+
+TEST(debounce, single_event)
+{
+    u64_ms_t test_start = system_uptime_get_ms();
+
+    debounce_trigger(&debounce);
+
+    work_run_for(9);
+    CHECK_EQUAL(0, s_executions);
+
+    work_run_for(10);
+    CHECK_EQUAL(1, s_executions);
+    CHECK_EQUAL(test_start + 10, s_last_execution);
+    CHECK_EQUAL(0, debounce.suppressed);
+}
+
+TEST(debounce, bounce_extends_quiet_period)
+{
+    u64_ms_t test_start = system_uptime_get_ms();
+
+    for (int i = 0; i < 5; i++) {
+        debounce_trigger(&debounce);
+        work_run_for(4);
+    }
+
+    CHECK_EQUAL(0, s_executions);
+
+    // quiet period starts with the last event
+    work_run_for(20);
+    CHECK_EQUAL(1, s_executions);
+    CHECK_EQUAL(test_start + 16 + 10, s_last_execution);
+    CHECK_EQUAL(4, debounce.suppressed);
+}
+
+TEST(debounce, events_after_submission)
+{
+    debounce_trigger(&debounce);
+    work_run_for(20);
+
+    debounce_trigger(&debounce);
+    work_run_for(20);
+
+    CHECK_EQUAL(2, s_executions);
+    CHECK_EQUAL(0, debounce.suppressed);
+}
+
+TEST(debounce, cancel)
+{
+    debounce_trigger(&debounce);
+    debounce_cancel(&debounce);
+
+    work_run_for(20);
+    CHECK_EQUAL(0, s_executions);
+}
@@ -0,0 +1,130 @@
+#include <service/unit_test.h>
+#include <service/event_flags.h>
+#include <vector>
+
+static std::vector<std::pair<struct work *, uint32_t>> s_wakeups;
+
+static void waiter_handler(struct work *work)
+{
+    s_wakeups.emplace_back(work, event_waiter_matched(work));
+}
+
+TEST_GROUP(event_flags) {
+    struct event_flags events = EVENT_FLAGS_INITIALIZER();
+    struct event_waiter any = EVENT_WAITER_INITIALIZER(0, waiter_handler, 0x3, EVENT_WAIT_ANY);
+    struct event_waiter all = EVENT_WAITER_INITIALIZER(1, waiter_handler, 0x3, EVENT_WAIT_ALL);
+    struct event_waiter clear = EVENT_WAITER_INITIALIZER(2, waiter_handler, 0x6, EVENT_WAIT_ANY | EVENT_WAIT_CLEAR);
+
+    void setup() override
+    {
+        s_wakeups.clear();
+    }
+
+    void teardown() override
+    {
+        for (auto *waiter: { &any, &all, &clear }) {
+            event_flags_cancel(&events, waiter);
+            work_cancel(&waiter->work);
+        }
+    }
+
+    void check(std::vector<std::pair<struct work *, uint32_t>> expected)
+    {
+        CHECK_EQUAL(expected.size(), s_wakeups.size());
+        CHECK_TRUE(expected == s_wakeups);
+        s_wakeups.clear();
+    }
+};
+
+TEST(event_flags, wait_any)
+{
+    event_flags_wait(&events, &any);
+
+    event_flags_post(&events, 0x4);
+    work_run_for(0);
+    check({});
+
+    event_flags_post(&events, 0x2);
+    work_run_for(0);
+    check({ { &any.work, 0x2 } });
+
+    // waiters are one-shot
+    event_flags_post(&events, 0x1);
+    work_run_for(0);
+    check({});
+}
+
+TEST(event_flags, wait_all)
+{
+    event_flags_wait(&events, &all);
+
+    event_flags_post(&events, 0x1);
+    work_run_for(0);
+    check({});
+
+    event_flags_post(&events, 0x2);
+    work_run_for(0);
+    check({ { &all.work, 0x3 } });
+}
+
+TEST(event_flags, already_set)
+{
+    event_flags_post(&events, 0x1);
+    event_flags_wait(&events, &any);
+
+    work_run_for(0);
+    check({ { &any.work, 0x1 } });
+    CHECK_EQUAL(0x1, event_flags_get(&events));
+}
+
+TEST(event_flags, clear_on_match)
+{
+    event_flags_wait(&events, &clear);
+    event_flags_wait(&events, &any);
+
+    event_flags_post(&events, 0x3);
+    work_run_for(0);
+    check({ { &any.work, 0x1 }, { &clear.work, 0x2 } });
+    CHECK_EQUAL(0x1, event_flags_get(&events));
+}
+
+TEST(event_flags, cleared_bits_hidden_from_later_waiters)
+{
+    struct event_waiter later = EVENT_WAITER_INITIALIZER(3, waiter_handler, 0x2, EVENT_WAIT_ANY);
+
+    event_flags_wait(&events, &clear);
+    event_flags_wait(&events, &later);
+
+    event_flags_post(&events, 0x2);
+    work_run_for(0);
+    check({ { &clear.work, 0x2 } });
+
+    event_flags_cancel(&events, &later);
+}
+
+TEST(event_flags, single_post_wakes_multiple)
+{
+    event_flags_wait(&events, &any);
+    event_flags_wait(&events, &all);
+
+    event_flags_post(&events, 0x3);
+    work_run_for(0);
+    check({ { &any.work, 0x3 }, { &all.work, 0x3 } });
+}
+
+TEST(event_flags, cancel)
+{
+    event_flags_wait(&events, &any);
+    event_flags_cancel(&events, &any);
+
+    event_flags_post(&events, 0x1);
+    work_run_for(0);
+    check({});
+}
+
+TEST(event_flags, clear)
+{
+    event_flags_post(&events, 0x7);
+    event_flags_clear(&events, 0x5);
+    CHECK_EQUAL(0x2, event_flags_get(&events));
+}
@@ -0,0 +1,158 @@
+#include <service/unit_test.h>
+#include <service/hsm.h>
+#include <string>
+#include <vector>
+
+enum {
+    STATE_OFF,
+    STATE_ON,
+    STATE_IDLE,
+    STATE_ACTIVE,
+    STATE_COUNT,
+};
+
+enum {
+    SIGNAL_POWER,
+    SIGNAL_START,
+    SIGNAL_RESET,
+    SIGNAL_RESTART,
+    SIGNAL_IGNORED,
+};
+
+static std::vector<std::string> s_trace;
+
+extern const struct hsm_state s_states[STATE_COUNT];
+
+#define TRACE_STATE(_name) \
+    static void _name##_entry(struct hsm *) { s_trace.push_back(#_name "+"); } \
+    static void _name##_exit(struct hsm *) { s_trace.push_back(#_name "-"); }
+
+TRACE_STATE(off)
+TRACE_STATE(on)
+TRACE_STATE(idle)
+TRACE_STATE(active)
+
+static enum hsm_result off_handler(struct hsm *hsm, const struct hsm_event *event)
+{
+    if (event->signal == SIGNAL_POWER) {
+        return hsm_transition(hsm, &s_states[STATE_ON]);
+    }
+
+    return HSM_UNHANDLED;
+}
+
+static enum hsm_result on_handler(struct hsm *hsm, const struct hsm_event *event)
+{
+    switch (event->signal) {
+        case SIGNAL_POWER: return hsm_transition(hsm, &s_states[STATE_OFF]);
+        case SIGNAL_RESET: return hsm_transition(hsm, &s_states[STATE_ON]);
+        case SIGNAL_START: return hsm_transition(hsm, &s_states[STATE_ACTIVE]);
+        default: return HSM_UNHANDLED;
+    }
+}
+
+static enum hsm_result active_handler(struct hsm *hsm, const struct hsm_event *event)
+{
+    switch (event->signal) {
+        case SIGNAL_START: return HSM_HANDLED;
+        case SIGNAL_RESTART: return hsm_transition(hsm, &s_states[STATE_ACTIVE]);
+        default: return HSM_UNHANDLED;
+    }
+}
+
+const struct hsm_state s_states[STATE_COUNT] = {
+    { "off", NULL, NULL, off_entry, off_exit, off_handler },
+    { "on", NULL, &s_states[STATE_IDLE], on_entry, on_exit, on_handler },
+    { "idle", &s_states[STATE_ON], NULL, idle_entry, idle_exit, NULL },
+    { "active", &s_states[STATE_ON], NULL, active_entry, active_exit, active_handler },
+};
+
+HSM_DEFINE(s_hsm, s_states, &s_states[STATE_OFF]);
+
+TEST_GROUP(hsm) {
+    void setup() override
+    {
+        hsm_init(&s_hsm);
+        s_trace.clear();
+    }
+
+    void dispatch(uint32_t signal)
+    {
+        struct hsm_event event = { signal, 0 };
+        hsm_dispatch(&s_hsm, &event);
+    }
+
+    void check(const std::vector<std::string> &expected)
+    {
+        CHECK_TRUE(expected == s_trace);
+        s_trace.clear();
+    }
+};
+
+TEST(hsm, init)
+{
+    hsm_init(&s_hsm);
+    check({ "off+" });
+    POINTERS_EQUAL(&s_states[STATE_OFF], s_hsm.current);
+}
+
+TEST(hsm, lca_table)
+{
+    auto lca = [](int source, int target) { return s_hsm.lca[source * STATE_COUNT + target]; };
+
+    CHECK_EQUAL(STATE_ON, lca(STATE_IDLE, STATE_ACTIVE));
+    CHECK_EQUAL(STATE_ON, lca(STATE_ON, STATE_ACTIVE));
+    CHECK_EQUAL(STATE_ON, lca(STATE_ACTIVE, STATE_ACTIVE));
+    CHECK_EQUAL(HSM_STATE_NONE, lca(STATE_ON, STATE_ON));
+    CHECK_EQUAL(HSM_STATE_NONE, lca(STATE_ACTIVE, STATE_ON));
+    CHECK_EQUAL(HSM_STATE_NONE, lca(STATE_ACTIVE, STATE_OFF));
+}
+
+TEST(hsm, initial_transition)
+{
+    dispatch(SIGNAL_POWER);
+    check({ "off-", "on+", "idle+" });
+    POINTERS_EQUAL(&s_states[STATE_IDLE], s_hsm.current);
+    CHECK_TRUE(hsm_in_state(&s_hsm, &s_states[STATE_ON]));
+    CHECK_FALSE(hsm_in_state(&s_hsm, &s_states[STATE_OFF]));
+}
+
+TEST(hsm, handled_by_parent)
+{
+    dispatch(SIGNAL_POWER);
+    s_trace.clear();
+
+    // transition from the parent to a sibling of the current state
+    dispatch(SIGNAL_START);
+    check({ "idle-", "active+" });
+
+    // handled by the current state, parent is not asked
+    dispatch(SIGNAL_START);
+    check({});
+
+    // transition from the parent exits all substates
+    dispatch(SIGNAL_POWER);
+    check({ "active-", "on-", "off+" });
+}
+
+TEST(hsm, self_transition)
+{
+    dispatch(SIGNAL_POWER);
+    dispatch(SIGNAL_START);
+    s_trace.clear();
+
+    dispatch(SIGNAL_RESTART);
+    check({ "active-", "active+" });
+
+    // transition of a parent to itself exits and enters it again
+    dispatch(SIGNAL_RESET);
+    check({ "active-", "on-", "on+", "idle+" });
+}
+
+TEST(hsm, unhandled)
+{
+    dispatch(SIGNAL_IGNORED);
+    dispatch(SIGNAL_START);
+    check({});
+    POINTERS_EQUAL(&s_states[STATE_OFF], s_hsm.current);
+}
@@ -1,4 +1,5 @@
 #include <service/log.h>
+#include <service/log_backend_fake.h>
 #include <service/work.h>
 #include <service/system.h>
 #include <service/unit_test.h>
@@ -7,13 +8,57 @@
 #include <regex>
 #include <sstream>
 #include <iomanip>
+#include <cstring>
 
 #define ANY_TIMESTAMP "\\[[0-9]{2,}:[0-9]{2}:[0-9]{2}.[0-9]{3},[0-9]{3}\\] "
 
 LOG_MODULE_REGISTER(test_log);
 
+// second module limited to warnings at compile time, in its own scope to not collide with test_log
+namespace compiled_wrn {
+    LOG_MODULE_REGISTER(test_log_wrn, LOG_LEVEL_WRN);
+
+    static void log_all()
+    {
+        LOG_DBG("debug");
+        LOG_INF("information");
+        LOG_WRN("warning");
+        LOG_ERR("error");
+    }
+}
+
+static int evaluated(int value, int &count)
+{
+    count++;
+    return value;
+}
+
 static bool new_line = true;
 static std::vector<std::string> output_lines;
+static std::vector<uint8_t> output_bytes;
+
+// second backend collecting warnings and errors
+static std::string errors_output;
+static bool errors_registered;
+
+static void errors_transmit(struct log_backend *backend, const uint8_t *data, size_t length)
+{
+    errors_output.append(reinterpret_cast<const char *>(data), length);
+    log_backend_transmit_done(backend);
+}
+
+static size_t errors_panic(struct log_backend *backend)
+{
+    (void) backend;
+    return 0;
+}
+
+static const struct log_backend_api errors_api = {
+    errors_transmit,
+    errors_panic,
+};
+
+LOG_BACKEND_DEFINE(errors_backend, &errors_api, 256, LOG_LEVEL_WRN);
 
 static void match_line(ssize_t index, const std::string &regex)
 {
@@ -61,6 +106,8 @@ static std::string format_timestamp(u64_us_t uptime)
 // override to capture output
 void system_debug_out(char c)
 {
+    output_bytes.push_back(static_cast<uint8_t>(c));
+
     if (new_line) {
         if (c != '\n') {
             output_lines.emplace_back(1, c);
@@ -79,13 +126,46 @@ TEST_GROUP(log) {
     void setup() override
     {
         output_lines.clear();
+        output_bytes.clear();
+        errors_output.clear();
         new_line = true;
 
         // make sure uptime is not zero and different uptimes are used for each test
         system_busy_sleep_us(123'456);
+
+        // text output is expected unless a test enables binary output, which LOG_BINARY makes the default
+        log_set_binary(false);
+
+        log_backend_fake_reset(true);
+        log_backend_register(&log_backend_fake);
+    }
+
+    void teardown() override
+    {
+        // flush anything left by the test
+        log_panic();
+
+        log_set_binary(false);
+        log_set_policy(LOG_LANE_HIGH, LOG_POLICY_DROP_NEWEST);
+        log_set_policy(LOG_LANE_LOW, LOG_POLICY_DROP_NEWEST);
+        log_backend_unregister(&log_backend_fake);
+
+        if (errors_registered) {
+            log_backend_unregister(&errors_backend);
+            errors_registered = false;
+        }
     }
 };
 
+template <typename T>
+static T read_frame_value(size_t &offset)
+{
+    T value;
+    std::memcpy(&value, output_bytes.data() + offset, sizeof(value));
+    offset += sizeof(value);
+    return value;
+}
+
 TEST(log, level_all)
 {
     log_set_level("test_log", LOG_LEVEL_DBG);
@@ -121,6 +201,101 @@ TEST(log, level_filtered)
     match_line(1, ANY_TIMESTAMP "<err> test_log: error");
 }
 
+TEST(log, level_arguments_not_evaluated)
+{
+    log_set_level("test_log", LOG_LEVEL_WRN);
+    int count = 0;
+
+    LOG_DBG("debug %d", evaluated(1, count));
+    LOG_WRN("warning %d", evaluated(2, count));
+
+    work_run_for(0);
+
+    CHECK_EQUAL(1, count);
+    CHECK_EQUAL(1, output_lines.size());
+    match_line(0, ANY_TIMESTAMP "<wrn> test_log: warning 2");
+}
+
+TEST(log, level_compiled)
+{
+    // more verbose levels than compiled in cannot be enabled at runtime
+    log_set_level("test_log_wrn", LOG_LEVEL_DBG);
+    compiled_wrn::log_all();
+    work_run_for(0);
+
+    CHECK_EQUAL(2, output_lines.size());
+    match_line(0, ANY_TIMESTAMP "<wrn> test_log_wrn: warning");
+    match_line(1, ANY_TIMESTAMP "<err> test_log_wrn: error");
+
+    // compiled levels can still be restricted at runtime
+    output_lines.clear();
+    log_set_level("test_log_wrn", LOG_LEVEL_ERR);
+    compiled_wrn::log_all();
+    work_run_for(0);
+
+    CHECK_EQUAL(1, output_lines.size());
+    match_line(0, ANY_TIMESTAMP "<err> test_log_wrn: error");
+}
+
+TEST(log, format_runtime)
+{
+    // messages not created by the macros are captured at runtime into the same package layout
+    log_message(&__log_module, LOG_LEVEL_INF, "%s %hhd %hu", "runtime", static_cast<signed char>(-3), 60000);
+
+    work_run_for(0);
+
+    CHECK_EQUAL(1, output_lines.size());
+    match_line(0, ANY_TIMESTAMP "<inf> test_log: runtime -3 60000");
+}
+
+static void log_limited(int index)
+{
+    LOG_RATELIMIT(LOG_LEVEL_ERR, 2, 100, "limited %d", index);
+}
+
+TEST(log, ratelimit)
+{
+    for (int i = 0; i < 5; i++) {
+        log_limited(i);
+    }
+
+    // another call site is not affected
+    LOG_ERR_RATELIMIT("other");
+
+    work_run_for(0);
+
+    CHECK_EQUAL(3, output_lines.size());
+    match_line(0, ANY_TIMESTAMP "<err> test_log: limited 0");
+    match_line(1, ANY_TIMESTAMP "<err> test_log: limited 1");
+    match_line(2, ANY_TIMESTAMP "<err> test_log: other");
+
+    // one message is regained per interval
+    output_lines.clear();
+    system_busy_sleep_ms(100);
+
+    log_limited(5);
+    log_limited(6);
+    work_run_for(0);
+
+    CHECK_EQUAL(2, output_lines.size());
+    match_line(0, ANY_TIMESTAMP "<err> test_log: 3 messages suppressed");
+    match_line(1, ANY_TIMESTAMP "<err> test_log: limited 5");
+
+    // the bucket is full again after burst intervals
+    output_lines.clear();
+    system_busy_sleep_ms(1000);
+
+    log_limited(7);
+    log_limited(8);
+    log_limited(9);
+    work_run_for(0);
+
+    CHECK_EQUAL(3, output_lines.size());
+    match_line(0, ANY_TIMESTAMP "<err> test_log: 1 messages suppressed");
+    match_line(1, ANY_TIMESTAMP "<err> test_log: limited 7");
+    match_line(2, ANY_TIMESTAMP "<err> test_log: limited 8");
+}
+
 TEST(log, buffer_overflow)
 {
     // log a message
@@ -168,6 +343,86 @@ TEST(log, format_string)
     match_line(2, ANY_TIMESTAMP "<inf> test_log: hello 000123 000456!");
 }
 
+TEST(log, lane_reserved)
+{
+    // debug messages cannot take the space of errors
+    for (size_t i = 0; i < 10000; i++) {
+        LOG_INF("spam");
+    }
+
+    LOG_ERR("error");
+    work_run_for(0);
+
+    CHECK_TRUE(2 < output_lines.size());
+    match_line(0, "--- [0-9]+ messages dropped ---");
+    match_line(-1, ANY_TIMESTAMP "<err> test_log: error");
+}
+
+TEST(log, lane_overwrite)
+{
+    log_set_policy(LOG_LANE_LOW, LOG_POLICY_OVERWRITE_OLDEST);
+
+    // start without a sync record in the lane
+    LOG_INF("hello");
+    work_run_for(0);
+    output_lines.clear();
+
+    for (unsigned i = 0; i < 1000; i++) {
+        LOG_INF("message %u", i);
+    }
+
+    work_run_for(0);
+
+    // the newest messages are kept, the dropped count matches the overwritten messages
+    std::smatch dropped;
+    CHECK_TRUE(2 < output_lines.size());
+    CHECK_TRUE(std::regex_search(output_lines[0], dropped, std::regex("--- ([0-9]+) messages dropped ---")));
+    CHECK_EQUAL(1000, std::stoul(dropped[1]) + output_lines.size() - 1);
+    match_line(-1, ANY_TIMESTAMP "<inf> test_log: message 999");
+}
+
+TEST(log, lane_overwrite_hexdump)
+{
+    log_set_policy(LOG_LANE_LOW, LOG_POLICY_OVERWRITE_OLDEST);
+
+    uint8_t data[20];
+
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = static_cast<uint8_t>(0x30 + i);
+    }
+
+    // messages of overwriting lanes are formatted from a copy, hexdumps are copied again for each line
+    LOG_HEXDUMP_INF(data, sizeof(data), "packet");
+    LOG_INF("after");
+
+    work_run_for(0);
+
+    CHECK_EQUAL(4, output_lines.size());
+    match_line(0, ANY_TIMESTAMP "<inf> test_log: packet");
+    CHECK_EQUAL("    0000: 30 31 32 33 34 35 36 37 38 39 3a 3b 3c 3d 3e 3f  |0123456789:;<=>?|", output_lines[1]);
+    CHECK_EQUAL("    0010: 40 41 42 43                                      |@ABC|", output_lines[2]);
+    match_line(3, ANY_TIMESTAMP "<inf> test_log: after");
+}
+
+TEST(log, lane_interleaved)
+{
+    LOG_INF("first");
+    system_busy_sleep_us(1);
+    LOG_ERR("second");
+    system_busy_sleep_us(1);
+    LOG_INF("third");
+    system_busy_sleep_us(1);
+    LOG_WRN("fourth");
+
+    work_run_for(0);
+
+    CHECK_EQUAL(4, output_lines.size());
+    match_line(0, ANY_TIMESTAMP "<inf> test_log: first");
+    match_line(1, ANY_TIMESTAMP "<err> test_log: second");
+    match_line(2, ANY_TIMESTAMP "<inf> test_log: third");
+    match_line(3, ANY_TIMESTAMP "<wrn> test_log: fourth");
+}
+
 TEST(log, timestamp)
 {
     // log messages
@@ -211,3 +466,297 @@ TEST(log, timestamp)
     match_line(5, format_timestamp(after_h) + "<inf> test_log: after hours");
     match_line(6, format_timestamp(after_y) + "<inf> test_log: after years");
 }
+
+TEST(log, timestamp_filtered)
+{
+    log_backend_register(&errors_backend);
+    errors_registered = true;
+
+    // the sync record before the second message is read by the backend although it skips the first one
+    LOG_INF("skipped");
+    system_busy_sleep_ms(2 * 1000 * 60 * 60);
+
+    u64_us_t after_h = system_uptime_get_us();
+    LOG_ERR("after hours");
+    system_busy_sleep_ms(1000);
+
+    u64_us_t after_s = system_uptime_get_us();
+    LOG_ERR("after seconds");
+
+    work_run_for(0);
+
+    std::regex ansi_escape("\\x1B\\[[0-?]*[ -/]*[@-~]");
+    std::string errors = std::regex_replace(errors_output, ansi_escape, "");
+    std::string expected = format_timestamp(after_h) + "<err> test_log: after hours\n" +
+                           format_timestamp(after_s) + "<err> test_log: after seconds\n";
+
+    CHECK_TRUE_TEXT(std::regex_match(errors, std::regex(expected)), errors.c_str());
+}
+
+TEST(log, hexdump)
+{
+    uint8_t data[20];
+
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = static_cast<uint8_t>(0x30 + i);
+    }
+
+    data[0] = 0x00;
+    data[1] = 0xFF;
+
+    LOG_HEXDUMP_INF(data, sizeof(data), "packet");
+    LOG_INF("after");
+
+    work_run_for(0);
+
+    CHECK_EQUAL(4, output_lines.size());
+    match_line(0, ANY_TIMESTAMP "<inf> test_log: packet");
+    CHECK_EQUAL("    0000: 00 ff 32 33 34 35 36 37 38 39 3a 3b 3c 3d 3e 3f  |..23456789:;<=>?|", output_lines[1]);
+    CHECK_EQUAL("    0010: 40 41 42 43                                      |@ABC|", output_lines[2]);
+    match_line(3, ANY_TIMESTAMP "<inf> test_log: after");
+}
+
+TEST(log, hexdump_truncated)
+{
+    uint8_t data[LOG_HEXDUMP_MAX_LENGTH + 10] = {};
+
+    LOG_HEXDUMP_ERR(data, 0, "empty");
+    LOG_HEXDUMP_ERR(data, sizeof(data), "long");
+
+    // lines are output one by one through the asynchronous backend
+    log_backend_fake_reset(false);
+    work_run_for(0);
+
+    while (log_backend_fake_pending() > 0) {
+        log_backend_fake_complete();
+        work_run_for(0);
+    }
+
+    CHECK_EQUAL(2 + LOG_HEXDUMP_MAX_LENGTH / 16, output_lines.size());
+    match_line(0, ANY_TIMESTAMP "<err> test_log: empty");
+    match_line(1, ANY_TIMESTAMP "<err> test_log: long");
+    match_line(-1, "    00[0-9a-f]{2}: (00 ){16} \\|\\.{16}\\|");
+}
+
+TEST(log, hexdump_binary)
+{
+    static const char *description = "blob";
+    static const uint8_t data[] = { 1, 2, 3 };
+
+    log_set_binary(true);
+
+    u64_us_t timestamp = system_uptime_get_us();
+    LOG_HEXDUMP_WRN(data, sizeof(data), description);
+
+    work_run_for(0);
+
+    // sync byte, type, length, header, description and data, checksum
+    size_t length = sizeof(void *) + sizeof(u64_us_t) + 1 + sizeof(char *) + sizeof(data);
+    CHECK_EQUAL(3 + length + 1, output_bytes.size());
+    CHECK_EQUAL(2, output_bytes[1]);
+    CHECK_EQUAL(length, output_bytes[2]);
+
+    size_t offset = 3;
+    CHECK_EQUAL(&__log_module, read_frame_value<const struct log_module *>(offset));
+    CHECK_EQUAL(timestamp, read_frame_value<u64_us_t>(offset));
+    CHECK_EQUAL(LOG_LEVEL_WRN, read_frame_value<uint8_t>(offset));
+    CHECK_EQUAL(description, read_frame_value<const char *>(offset));
+    MEMCMP_EQUAL(data, output_bytes.data() + offset, sizeof(data));
+}
+
+TEST(log, binary_frame)
+{
+    static const char *format = "value %d %s";
+    static const char *argument = "arg";
+
+    log_set_binary(true);
+
+    u64_us_t timestamp = system_uptime_get_us();
+    LOG_WRN(format, -42, argument);
+
+    work_run_for(0);
+
+    // sync byte, type, length, header and package, checksum
+    size_t length = sizeof(void *) + sizeof(u64_us_t) + 1 + sizeof(char *) + sizeof(int) + sizeof(char *);
+    CHECK_EQUAL(3 + length + 1, output_bytes.size());
+    CHECK_EQUAL(0xA5, output_bytes[0]);
+    CHECK_EQUAL(0, output_bytes[1]);
+    CHECK_EQUAL(length, output_bytes[2]);
+
+    size_t offset = 3;
+    CHECK_EQUAL(&__log_module, read_frame_value<const struct log_module *>(offset));
+    CHECK_EQUAL(timestamp, read_frame_value<u64_us_t>(offset));
+    CHECK_EQUAL(LOG_LEVEL_WRN, read_frame_value<uint8_t>(offset));
+    CHECK_EQUAL(format, read_frame_value<const char *>(offset));
+    CHECK_EQUAL(-42, read_frame_value<int>(offset));
+    CHECK_EQUAL(argument, read_frame_value<const char *>(offset));
+
+    uint8_t checksum = 0;
+
+    for (size_t i = 1; i < output_bytes.size(); i++) {
+        checksum ^= output_bytes[i];
+    }
+
+    CHECK_EQUAL(0, checksum);
+}
+
+TEST(log, binary_dropped)
+{
+    log_set_binary(true);
+
+    for (size_t i = 0; i < 10000; i++) {
+        LOG_INF("spam");
+    }
+
+    work_run_for(0);
+
+    // the dropped frame comes first
+    CHECK_TRUE(9 < output_bytes.size());
+    CHECK_EQUAL(0xA5, output_bytes[0]);
+    CHECK_EQUAL(1, output_bytes[1]);
+    CHECK_EQUAL(sizeof(uint32_t) + sizeof(uint8_t), output_bytes[2]);
+
+    size_t offset = 3;
+    CHECK_TRUE(0 < read_frame_value<uint32_t>(offset));
+    CHECK_EQUAL(LOG_LANE_LOW, read_frame_value<uint8_t>(offset));
+    CHECK_EQUAL(output_bytes[1] ^ output_bytes[2] ^ output_bytes[3] ^ output_bytes[4] ^ output_bytes[5] ^
+                output_bytes[6] ^ output_bytes[7], output_bytes[8]);
+    CHECK_EQUAL(0xA5, output_bytes[9]);
+}
+
+TEST(log, async_output)
+{
+    log_backend_fake_reset(false);
+
+    for (int i = 0; i < 10; i++) {
+        LOG_INF("message %d", i);
+    }
+
+    work_run_for(0);
+
+    // the first line is being transmitted, further lines are formatted until the TX buffer is full
+    CHECK_EQUAL(0, output_lines.size());
+    CHECK_TRUE(0 < log_backend_fake_pending());
+
+    log_backend_fake_complete();
+    CHECK_EQUAL(1, output_lines.size());
+
+    // formatting continues as transmissions complete
+    while (log_backend_fake_pending() > 0) {
+        log_backend_fake_complete();
+        work_run_for(0);
+    }
+
+    CHECK_EQUAL(10, output_lines.size());
+
+    for (int i = 0; i < 10; i++) {
+        match_line(i, ANY_TIMESTAMP "<inf> test_log: message " + std::to_string(i));
+    }
+}
+
+TEST(log, async_stalled)
+{
+    log_backend_fake_reset(false);
+
+    for (int i = 0; i < 10; i++) {
+        LOG_INF("message %d", i);
+    }
+
+    work_run_for(0);
+    size_t pending = log_backend_fake_pending();
+
+    // nothing is formatted while the backend does not complete
+    LOG_INF("later");
+    work_run_for(0);
+
+    CHECK_EQUAL(0, output_lines.size());
+    CHECK_EQUAL(pending, log_backend_fake_pending());
+}
+
+TEST(log, async_panic)
+{
+    log_backend_fake_reset(false);
+
+    for (int i = 0; i < 10; i++) {
+        LOG_INF("message %d", i);
+    }
+
+    work_run_for(0);
+    CHECK_EQUAL(0, output_lines.size());
+
+    // formatted and recorded messages are written synchronously
+    log_panic();
+
+    CHECK_EQUAL(0, log_backend_fake_pending());
+    CHECK_EQUAL(10, output_lines.size());
+
+    for (int i = 0; i < 10; i++) {
+        match_line(i, ANY_TIMESTAMP "<inf> test_log: message " + std::to_string(i));
+    }
+}
+
+TEST(log, backend_filters)
+{
+    log_set_level("test_log", LOG_LEVEL_DBG);
+    log_backend_set_level(&log_backend_fake, LOG_LEVEL_INF);
+    log_backend_register(&errors_backend);
+    errors_registered = true;
+
+    LOG_DBG("debug");
+    LOG_INF("information");
+    LOG_WRN("warning");
+    LOG_ERR("error");
+
+    work_run_for(0);
+
+    CHECK_EQUAL(3, output_lines.size());
+    match_line(0, ANY_TIMESTAMP "<inf> test_log: information");
+    match_line(1, ANY_TIMESTAMP "<wrn> test_log: warning");
+    match_line(2, ANY_TIMESTAMP "<err> test_log: error");
+
+    CHECK_TRUE(errors_output.find("information") == std::string::npos);
+    CHECK_TRUE(errors_output.find("<wrn> test_log: warning") != std::string::npos);
+    CHECK_TRUE(errors_output.find("<err> test_log: error") != std::string::npos);
+}
+
+TEST(log, backend_filters_capture)
+{
+    log_set_level("test_log", LOG_LEVEL_DBG);
+    log_backend_set_level(&log_backend_fake, LOG_LEVEL_WRN);
+
+    // messages no backend wants are not recorded and cannot overflow the buffer
+    for (size_t i = 0; i < 10000; i++) {
+        LOG_INF("spam");
+    }
+
+    LOG_WRN("warning");
+    work_run_for(0);
+
+    CHECK_EQUAL(1, output_lines.size());
+    match_line(0, ANY_TIMESTAMP "<wrn> test_log: warning");
+}
+
+TEST(log, backend_independent)
+{
+    log_backend_fake_reset(false);
+    log_backend_register(&errors_backend);
+    errors_registered = true;
+
+    LOG_ERR("first");
+    LOG_ERR("second");
+
+    work_run_for(0);
+
+    // the stalled backend does not hold back the other one
+    CHECK_EQUAL(0, output_lines.size());
+    CHECK_TRUE(errors_output.find("second") != std::string::npos);
+
+    while (log_backend_fake_pending() > 0) {
+        log_backend_fake_complete();
+        work_run_for(0);
+    }
+
+    CHECK_EQUAL(2, output_lines.size());
+    match_line(0, ANY_TIMESTAMP "<err> test_log: first");
+    match_line(1, ANY_TIMESTAMP "<err> test_log: second");
+}
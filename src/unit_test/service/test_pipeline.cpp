@@ -0,0 +1,185 @@
+#include <service/unit_test.h>
+#include <service/pipeline.h>
+#include <service/system.h>
+#include <cstring>
+#include <vector>
+
+#define BLOCK_SAMPLES    8
+
+static std::vector<const void *> s_gain_inputs;
+
+static size_t gain_process(struct pipeline_stage *, const void *input, size_t length, void *output)
+{
+    const int16_t *samples = static_cast<const int16_t *>(input);
+    int16_t *result = static_cast<int16_t *>(output);
+
+    s_gain_inputs.push_back(input);
+
+    for (size_t i = 0; i < length / sizeof(int16_t); i++) {
+        result[i] = (int16_t) (samples[i] * 2);
+    }
+
+    return length;
+}
+
+static size_t decimate_process(struct pipeline_stage *, const void *input, size_t length, void *output)
+{
+    const int16_t *samples = static_cast<const int16_t *>(input);
+    int16_t *result = static_cast<int16_t *>(output);
+
+    for (size_t i = 0; i < length / sizeof(int16_t) / 2; i++) {
+        result[i] = samples[2 * i];
+    }
+
+    return length / 2;
+}
+
+PIPELINE_SOURCE_DEFINE(s_source, BLOCK_SAMPLES * sizeof(int16_t));
+PIPELINE_STAGE_DEFINE(s_gain, 1, gain_process, BLOCK_SAMPLES * sizeof(int16_t));
+PIPELINE_STAGE_DEFINE(s_decimate, 2, decimate_process, BLOCK_SAMPLES * sizeof(int16_t) / 2);
+
+TEST_GROUP(pipeline) {
+    void setup() override
+    {
+        for (auto *stage: { &s_source, &s_gain, &s_decimate }) {
+            work_cancel(&stage->work);
+            stage->write_index = 0;
+            stage->read_index = 0;
+            stage->full_count = 0;
+        }
+
+        pipeline_connect(&s_source, &s_gain);
+        pipeline_connect(&s_gain, &s_decimate);
+
+        struct pipeline_stats stats;
+
+        for (auto *stage: { &s_source, &s_gain, &s_decimate }) {
+            pipeline_stats_read(stage, &stats);
+        }
+
+        s_gain_inputs.clear();
+    }
+
+    bool produce(int16_t first)
+    {
+        auto *samples = static_cast<int16_t *>(pipeline_acquire(&s_source));
+
+        if (samples == nullptr) {
+            return false;
+        }
+
+        for (int16_t i = 0; i < BLOCK_SAMPLES; i++) {
+            samples[i] = (int16_t) (first + i);
+        }
+
+        pipeline_commit(&s_source, BLOCK_SAMPLES * sizeof(int16_t));
+        return true;
+    }
+
+    std::vector<int16_t> consume()
+    {
+        size_t length = 0;
+        auto *samples = static_cast<const int16_t *>(pipeline_peek(&s_decimate, &length));
+
+        if (samples == nullptr) {
+            return {};
+        }
+
+        std::vector<int16_t> result(samples, samples + length / sizeof(int16_t));
+        pipeline_release(&s_decimate);
+
+        return result;
+    }
+};
+
+TEST(pipeline, zero_copy_flow)
+{
+    const void *source_buffer = s_source.buffers[0];
+
+    CHECK_TRUE(produce(1));
+    work_run_for(0);
+
+    // stages process the upstream buffer in place
+    CHECK_EQUAL(1, s_gain_inputs.size());
+    POINTERS_EQUAL(source_buffer, s_gain_inputs[0]);
+
+    CHECK_TRUE((std::vector<int16_t>{ 2, 6, 10, 14 }) == consume());
+    CHECK_TRUE(consume().empty());
+}
+
+TEST(pipeline, ping_pong)
+{
+    CHECK_TRUE(produce(0));
+    CHECK_TRUE(produce(10));
+    work_run_for(0);
+
+    POINTERS_EQUAL(s_source.buffers[0], s_gain_inputs[0]);
+    POINTERS_EQUAL(s_source.buffers[1], s_gain_inputs[1]);
+
+    CHECK_TRUE((std::vector<int16_t>{ 0, 4, 8, 12 }) == consume());
+    CHECK_TRUE((std::vector<int16_t>{ 20, 24, 28, 32 }) == consume());
+}
+
+TEST(pipeline, backpressure)
+{
+    // fill the output of the last stage, then the buffers of the gain stage and the source
+    for (int16_t i = 0; i < 6; i++) {
+        CHECK_TRUE(produce((int16_t) (i * 10)));
+        work_run_for(0);
+    }
+
+    CHECK_FALSE(produce(60));
+    CHECK_EQUAL(2, s_source.full_count);
+    CHECK_EQUAL(2, s_gain.full_count);
+    CHECK_EQUAL(2, s_decimate.full_count);
+
+    struct pipeline_stats stats;
+    pipeline_stats_read(&s_source, &stats);
+    CHECK_EQUAL(1, stats.stalls);
+
+    // releasing a single block lets every stage process one block
+    CHECK_TRUE((std::vector<int16_t>{ 0, 4, 8, 12 }) == consume());
+    work_run_for(0);
+    CHECK_EQUAL(1, s_source.full_count);
+    CHECK_TRUE(produce(60));
+
+    for (int16_t i = 1; i < 7; i++) {
+        std::vector<int16_t> expected;
+
+        for (int16_t j = 0; j < BLOCK_SAMPLES; j += 2) {
+            expected.push_back((int16_t) ((i * 10 + j) * 2));
+        }
+
+        CHECK_TRUE(expected == consume());
+        work_run_for(0);
+    }
+
+    CHECK_TRUE(consume().empty());
+}
+
+TEST(pipeline, stats)
+{
+    u64_us_t start = system_uptime_get_us();
+
+    for (int16_t i = 0; i < 4; i++) {
+        produce(i);
+        work_run_for(250);
+        consume();
+    }
+
+    u64_us_t now = system_uptime_get_us();
+    struct pipeline_stats stats;
+
+    pipeline_stats_read(&s_gain, &stats);
+    CHECK_EQUAL(4, stats.blocks);
+    CHECK_EQUAL(4 * BLOCK_SAMPLES * sizeof(int16_t), stats.bytes);
+    CHECK_EQUAL(0, stats.stalls);
+    CHECK_EQUAL(start, stats.since);
+    CHECK_EQUAL(4 * BLOCK_SAMPLES * sizeof(int16_t), pipeline_stats_byte_rate(&stats, now));
+
+    pipeline_stats_read(&s_decimate, &stats);
+    CHECK_EQUAL(4 * BLOCK_SAMPLES * sizeof(int16_t), stats.bytes);
+
+    pipeline_stats_read(&s_source, &stats);
+    CHECK_EQUAL(4, stats.blocks);
+}
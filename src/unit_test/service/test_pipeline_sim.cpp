@@ -0,0 +1,108 @@
+#include <service/unit_test.h>
+#include <service/pipeline_sim.h>
+#include <service/system_sim.h>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#define BLOCK_SAMPLES    8
+
+static std::thread::id s_copy_thread;
+static std::vector<int16_t> s_sink_firsts;
+static std::vector<u64_us_t> s_sink_uptimes;
+
+static size_t copy_process(struct pipeline_stage *, const void *input, size_t length, void *output)
+{
+    s_copy_thread = std::this_thread::get_id();
+    memcpy(output, input, length);
+    return length;
+}
+
+static size_t sink_process(struct pipeline_stage *, const void *input, size_t, void *)
+{
+    s_sink_firsts.push_back(static_cast<const int16_t *>(input)[0]);
+    s_sink_uptimes.push_back(system_uptime_get_us());
+    return 0;
+}
+
+PIPELINE_SOURCE_DEFINE(s_source, BLOCK_SAMPLES * sizeof(int16_t));
+PIPELINE_STAGE_DEFINE(s_copy, 1, copy_process, BLOCK_SAMPLES * sizeof(int16_t));
+PIPELINE_STAGE_DEFINE(s_sink, 2, sink_process, 0);
+
+static void producer_handler(struct work *work);
+static WORK_DEFINE(s_producer, 3, producer_handler);
+static int16_t s_produced;
+
+static bool produce(int16_t first)
+{
+    auto *samples = static_cast<int16_t *>(pipeline_acquire(&s_source));
+
+    if (samples == nullptr) {
+        return false;
+    }
+
+    for (int16_t i = 0; i < BLOCK_SAMPLES; i++) {
+        samples[i] = (int16_t) (first + i);
+    }
+
+    pipeline_commit(&s_source, BLOCK_SAMPLES * sizeof(int16_t));
+    return true;
+}
+
+static void producer_handler(struct work *work)
+{
+    CHECK_TRUE(produce(s_produced));
+    s_produced++;
+
+    if (s_produced < 4) {
+        work_schedule_after(work, 10);
+    }
+}
+
+TEST_GROUP(pipeline_sim) {
+    void setup() override
+    {
+        static bool initialized;
+
+        // the simulated system and the stage threads live until the test ends
+        if (!initialized) {
+            system_setup();
+
+            pipeline_connect(&s_source, &s_copy);
+            pipeline_connect(&s_copy, &s_sink);
+            pipeline_stage_pin_thread(&s_copy);
+
+            initialized = true;
+        }
+
+        s_copy_thread = {};
+        s_sink_firsts.clear();
+        s_sink_uptimes.clear();
+        s_produced = 0;
+    }
+};
+
+TEST(pipeline_sim, pinned_stage_wakes_up_work_queue)
+{
+    u64_us_t start = system_uptime_get_us();
+
+    CHECK_TRUE(produce(7));
+    work_run_for(1000);
+
+    // the stage thread submits the sink while the work queue sleeps until the end of the run
+    CHECK_TRUE(s_copy_thread != std::thread::id());
+    CHECK_TRUE(s_copy_thread != std::this_thread::get_id());
+    CHECK_EQUAL(1, s_sink_firsts.size());
+    CHECK_EQUAL(7, s_sink_firsts[0]);
+    CHECK_TRUE(s_sink_uptimes[0] - start < 250000);
+}
+
+TEST(pipeline_sim, pinned_stage_processes_blocks_in_order)
+{
+    work_submit(&s_producer);
+    work_run_for(500);
+
+    CHECK_TRUE((std::vector<int16_t>{ 0, 1, 2, 3 }) == s_sink_firsts);
+    CHECK_EQUAL(0, s_source.full_count);
+    CHECK_EQUAL(0, s_copy.full_count);
+}
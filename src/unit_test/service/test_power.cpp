@@ -0,0 +1,100 @@
+#include <service/unit_test.h>
+#include <service/system_fake.h>
+#include <service/power.h>
+#include <service/work.h>
+#include <util/unused.h>
+
+static void noop_handler(struct work *work)
+{
+    ARG_UNUSED(work);
+}
+
+static void record_wakeups(size_t count, u64_us_t idle_time, u64_us_t measured_time)
+{
+    for (size_t i = 0; i < count; i++) {
+        power_governor_menu.reflect(0, idle_time, measured_time);
+    }
+}
+
+TEST_GROUP(power) {
+    void setup() override { power_governor_set(&power_governor_menu); }
+    void teardown() override { power_governor_set(&power_governor_menu); }
+};
+
+TEST(power, select_by_idle_time)
+{
+    CHECK_EQUAL(SYSTEM_FAKE_SLEEP, power_select(0));
+    CHECK_EQUAL(SYSTEM_FAKE_SLEEP, power_select(999));
+    CHECK_EQUAL(SYSTEM_FAKE_STOP, power_select(1000));
+    CHECK_EQUAL(SYSTEM_FAKE_STOP, power_select(99999));
+    CHECK_EQUAL(SYSTEM_FAKE_STANDBY, power_select(100000));
+    CHECK_EQUAL(SYSTEM_FAKE_STANDBY, power_select(POWER_IDLE_TIME_INFINITE));
+}
+
+TEST(power, select_by_next_deadline)
+{
+    struct work work = WORK_INITIALIZER(0, noop_handler);
+
+    // long gap until the next deadline
+    work_schedule_after(&work, 500);
+    work_run_for(1000);
+    CHECK_EQUAL(SYSTEM_FAKE_STANDBY, system_fake_last_sleep_state());
+
+    // short gap until the next deadline
+    work_schedule_after(&work, 2);
+    work_run_for(4);
+    CHECK_EQUAL(SYSTEM_FAKE_STOP, system_fake_last_sleep_state());
+}
+
+TEST(power, early_wakeups_lower_prediction)
+{
+    // wake-ups by interrupts long before the deadline
+    record_wakeups(8, 1000000, 300);
+    CHECK_EQUAL(SYSTEM_FAKE_SLEEP, power_select(1000000));
+
+    // half of the history still early
+    record_wakeups(4, 1000000, 1000000);
+    CHECK_EQUAL(SYSTEM_FAKE_SLEEP, power_select(1000000));
+
+    // most wake-ups on time again
+    record_wakeups(1, 1000000, 1000000);
+    CHECK_EQUAL(SYSTEM_FAKE_STANDBY, power_select(1000000));
+}
+
+TEST(power, early_wakeups_never_raise_prediction)
+{
+    record_wakeups(8, POWER_IDLE_TIME_INFINITE, 50000);
+    CHECK_EQUAL(SYSTEM_FAKE_STOP, power_select(POWER_IDLE_TIME_INFINITE));
+    CHECK_EQUAL(SYSTEM_FAKE_SLEEP, power_select(500));
+}
+
+TEST(power, small_deviation_is_not_early)
+{
+    record_wakeups(8, 1000000, 950000);
+    CHECK_EQUAL(SYSTEM_FAKE_STANDBY, power_select(1000000));
+}
+
+TEST(power, custom_governor)
+{
+    static const struct power_governor always_stop = {
+        .reset = NULL,
+        .select = [](const struct system_sleep_state *, size_t, u64_us_t) -> size_t { return SYSTEM_FAKE_STOP; },
+        .reflect = NULL,
+    };
+
+    static const struct power_governor invalid = {
+        .reset = NULL,
+        .select = [](const struct system_sleep_state *, size_t count, u64_us_t) -> size_t { return count; },
+        .reflect = NULL,
+    };
+
+    struct work work = WORK_INITIALIZER(0, noop_handler);
+
+    power_governor_set(&always_stop);
+    work_schedule_after(&work, 500);
+    work_run_for(1000);
+    CHECK_EQUAL(SYSTEM_FAKE_STOP, system_fake_last_sleep_state());
+
+    power_governor_set(&invalid);
+    CHECK_EQUAL(SYSTEM_FAKE_SLEEP, power_select(POWER_IDLE_TIME_INFINITE));
+}
@@ -0,0 +1,307 @@
+#include <service/unit_test.h>
+#include <service/stream_buffer.h>
+#include <atomic>
+#include <string>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+STREAM_BUFFER_DEFINE(stream, 16);
+STREAM_BUFFER_DEFINE(messages, 32);
+STREAM_BUFFER_DEFINE(shared, 256);
+
+static std::string read_message(struct stream_buffer *buffer)
+{
+    struct stream_buffer_region region;
+
+    if (!stream_buffer_message_peek(buffer, &region)) {
+        return "<none>";
+    }
+
+    char data[64];
+    size_t length = stream_buffer_region_copy_out(&region, data);
+    stream_buffer_message_consume(buffer);
+
+    return std::string(data, length);
+}
+
+TEST_GROUP(stream_buffer) {
+    void teardown() override
+    {
+        stream.read = 0;
+        stream.write = 0;
+        messages.read = messages.write;
+        messages.overflows = 0;
+        memset(messages.data, 0, messages.size);
+    }
+};
+
+TEST(stream_buffer, write_read)
+{
+    char data[16];
+
+    CHECK_EQUAL(5, stream_buffer_write(&stream, "hello", 5));
+    CHECK_EQUAL(6, stream_buffer_write(&stream, " world", 6));
+
+    CHECK_EQUAL(11, stream_buffer_read(&stream, data, sizeof(data)));
+    MEMCMP_EQUAL("hello world", data, 11);
+
+    CHECK_EQUAL(0, stream_buffer_read(&stream, data, sizeof(data)));
+}
+
+TEST(stream_buffer, write_when_full)
+{
+    char data[16];
+
+    CHECK_EQUAL(10, stream_buffer_write(&stream, "0123456789", 10));
+    CHECK_EQUAL(6, stream_buffer_write(&stream, "abcdefghij", 10));
+    CHECK_EQUAL(0, stream_buffer_write(&stream, "x", 1));
+
+    CHECK_EQUAL(4, stream_buffer_read(&stream, data, 4));
+    MEMCMP_EQUAL("0123", data, 4);
+
+    // wraps around at the end of the buffer
+    CHECK_EQUAL(4, stream_buffer_write(&stream, "klmn", 4));
+
+    CHECK_EQUAL(16, stream_buffer_read(&stream, data, sizeof(data)));
+    MEMCMP_EQUAL("456789abcdefklmn", data, 16);
+}
+
+TEST(stream_buffer, two_segments)
+{
+    char data[16];
+    struct stream_buffer_region region;
+
+    stream_buffer_write(&stream, "0123456789ab", 12);
+    stream_buffer_read(&stream, data, 12);
+
+    // reserved region wraps around
+    CHECK_EQUAL(8, stream_buffer_reserve(&stream, 8, &region));
+    CHECK_EQUAL(4, region.length[0]);
+    CHECK_EQUAL(4, region.length[1]);
+    CHECK_EQUAL(stream.data + 12, region.data[0]);
+    CHECK_EQUAL(stream.data, region.data[1]);
+
+    // nothing visible until committed
+    CHECK_EQUAL(0, stream_buffer_peek(&stream, &region));
+
+    stream_buffer_reserve(&stream, 8, &region);
+    stream_buffer_region_copy_in(&region, "ABCDEFGH");
+    stream_buffer_commit(&stream, 8);
+
+    CHECK_EQUAL(8, stream_buffer_peek(&stream, &region));
+    CHECK_EQUAL(4, region.length[0]);
+    MEMCMP_EQUAL("ABCD", region.data[0], 4);
+    MEMCMP_EQUAL("EFGH", region.data[1], 4);
+
+    // partial consumption
+    stream_buffer_consume(&stream, 6);
+    CHECK_EQUAL(2, stream_buffer_peek(&stream, &region));
+    MEMCMP_EQUAL("GH", region.data[0], 2);
+}
+
+TEST(stream_buffer, region_parts)
+{
+    char data[16];
+    struct stream_buffer_region region;
+
+    stream_buffer_write(&stream, "0123456789ab", 12);
+    stream_buffer_read(&stream, data, 12);
+
+    // parts before, across and after the wraparound
+    CHECK_EQUAL(8, stream_buffer_reserve(&stream, 8, &region));
+    stream_buffer_region_write(&region, 0, "AB", 2);
+    stream_buffer_region_write(&region, 2, "CDEF", 4);
+    stream_buffer_region_write(&region, 6, "GH", 2);
+    MEMCMP_EQUAL("ABCD", region.data[0], 4);
+    MEMCMP_EQUAL("EFGH", region.data[1], 4);
+
+    stream_buffer_region_read(&region, 3, data, 3);
+    MEMCMP_EQUAL("DEF", data, 3);
+    stream_buffer_region_read(&region, 5, data, 3);
+    MEMCMP_EQUAL("FGH", data, 3);
+    stream_buffer_region_read(&region, 1, data, 2);
+    MEMCMP_EQUAL("BC", data, 2);
+}
+
+TEST(stream_buffer, messages)
+{
+    CHECK_TRUE(stream_buffer_message_put(&messages, "first", 5));
+    CHECK_TRUE(stream_buffer_message_put(&messages, "", 0));
+    CHECK_TRUE(stream_buffer_message_put(&messages, "third", 5));
+
+    CHECK_EQUAL("first", read_message(&messages));
+    CHECK_EQUAL("", read_message(&messages));
+    CHECK_EQUAL("third", read_message(&messages));
+    CHECK_EQUAL("<none>", read_message(&messages));
+}
+
+TEST(stream_buffer, message_wraparound)
+{
+    for (int i = 0; i < 20; i++) {
+        std::string message = "message " + std::to_string(i);
+
+        CHECK_TRUE(stream_buffer_message_put(&messages, message.c_str(), message.size()));
+        CHECK_EQUAL(message, read_message(&messages));
+    }
+
+    CHECK_EQUAL(0, messages.overflows);
+}
+
+TEST(stream_buffer, message_overflow)
+{
+    // header plus padded content: 12 + 12 + 16 bytes
+    CHECK_TRUE(stream_buffer_message_put(&messages, "01234567", 8));
+    CHECK_TRUE(stream_buffer_message_put(&messages, "0123456", 7));
+    CHECK_FALSE(stream_buffer_message_put(&messages, "0123456789", 10));
+    CHECK_TRUE(stream_buffer_message_put(&messages, "ab", 2));
+    CHECK_FALSE(stream_buffer_message_put(&messages, "", 0));
+
+    CHECK_EQUAL(2, messages.overflows);
+}
+
+TEST(stream_buffer, message_commit_order)
+{
+    struct stream_buffer_region first;
+    struct stream_buffer_region second;
+
+    CHECK_TRUE(stream_buffer_message_reserve(&messages, 5, &first));
+    CHECK_TRUE(stream_buffer_message_reserve(&messages, 6, &second));
+
+    stream_buffer_region_copy_in(&second, "second");
+    stream_buffer_message_commit(&messages, &second);
+
+    // later message waits for the earlier one
+    CHECK_EQUAL("<none>", read_message(&messages));
+
+    stream_buffer_region_copy_in(&first, "first");
+    stream_buffer_message_commit(&messages, &first);
+
+    CHECK_EQUAL("first", read_message(&messages));
+    CHECK_EQUAL("second", read_message(&messages));
+}
+
+TEST(stream_buffer, message_positions)
+{
+    struct stream_buffer_region region;
+    char data[16];
+
+    CHECK_TRUE(stream_buffer_message_put(&messages, "first", 5));
+    CHECK_TRUE(stream_buffer_message_put(&messages, "second", 6));
+
+    // the fast reader reads both messages
+    uint32_t fast = messages.read;
+
+    CHECK_TRUE(stream_buffer_message_peek_at(&messages, fast, &region));
+    CHECK_EQUAL(5, stream_buffer_region_copy_out(&region, data));
+    fast = stream_buffer_message_next(&region);
+
+    CHECK_TRUE(stream_buffer_message_peek_at(&messages, fast, &region));
+    CHECK_EQUAL(6, stream_buffer_region_copy_out(&region, data));
+    fast = stream_buffer_message_next(&region);
+
+    CHECK_FALSE(stream_buffer_message_peek_at(&messages, fast, &region));
+
+    // the slow reader reads one message, which can be freed
+    uint32_t slow = messages.read;
+
+    CHECK_TRUE(stream_buffer_message_peek_at(&messages, slow, &region));
+    slow = stream_buffer_message_next(&region);
+
+    stream_buffer_message_consume_to(&messages, slow);
+
+    // the slow reader still gets the second message
+    CHECK_EQUAL("second", read_message(&messages));
+    CHECK_EQUAL(fast, messages.read);
+}
+
+TEST(stream_buffer, concurrent_producers)
+{
+    constexpr uint32_t producers = 4;
+    constexpr uint32_t count = 20000;
+
+    struct message {
+        uint32_t producer;
+        uint32_t sequence;
+        uint8_t payload[16];
+    };
+
+    std::atomic<uint32_t> finished = 0;
+    std::vector<uint32_t> put(producers, 0);
+    std::vector<std::thread> threads;
+
+    for (uint32_t producer = 0; producer < producers; producer++) {
+        threads.emplace_back([&, producer]() {
+            for (uint32_t sequence = 0; sequence < count; sequence++) {
+                struct message message = { producer, sequence, {} };
+                memset(message.payload, (int) (sequence & 0xFF), sizeof(message.payload));
+
+                // different lengths per producer to move the wraparound point
+                size_t length = offsetof(struct message, payload) + 3 * producer + 1;
+
+                if (stream_buffer_message_put(&shared, &message, length)) {
+                    put[producer]++;
+                } else {
+                    // give the consumer a chance to catch up, the message stays dropped
+                    std::this_thread::yield();
+                }
+            }
+
+            finished++;
+        });
+    }
+
+    std::vector<uint32_t> received(producers, 0);
+    std::vector<int64_t> last(producers, -1);
+    bool ordered = true;
+    bool intact = true;
+
+    while (true) {
+        bool done = (finished == producers);
+        struct stream_buffer_region region;
+
+        if (!stream_buffer_message_peek(&shared, &region)) {
+            if (done) {
+                break;
+            }
+
+            std::this_thread::yield();
+            continue;
+        }
+
+        struct message message = {};
+        size_t length = stream_buffer_region_copy_out(&region, &message);
+        stream_buffer_message_consume(&shared);
+
+        if ((message.producer >= producers) ||
+            (length != offsetof(struct message, payload) + 3 * message.producer + 1)) {
+            intact = false;
+            break;
+        }
+
+        for (size_t i = 0; i < length - offsetof(struct message, payload); i++) {
+            intact &= (message.payload[i] == (message.sequence & 0xFF));
+        }
+
+        // messages of the same producer arrive in order, dropped messages leave gaps
+        ordered &= ((int64_t) message.sequence > last[message.producer]);
+        last[message.producer] = message.sequence;
+        received[message.producer]++;
+    }
+
+    for (auto &thread: threads) {
+        thread.join();
+    }
+
+    CHECK_TRUE(intact);
+    CHECK_TRUE(ordered);
+
+    uint32_t total = 0;
+
+    for (uint32_t producer = 0; producer < producers; producer++) {
+        CHECK_EQUAL(put[producer], received[producer]);
+        total += received[producer];
+    }
+
+    CHECK_EQUAL(producers * count, total + shared.overflows);
+}
@@ -0,0 +1,98 @@
+#include <service/unit_test.h>
+#include <service/throttle.h>
+#include <service/system.h>
+#include <util/unused.h>
+#include <vector>
+
+static std::vector<u64_ms_t> s_executions;
+
+static void target_handler(struct work *work)
+{
+    ARG_UNUSED(work);
+
+    s_executions.push_back(system_uptime_get_ms());
+}
+
+/**
+ * Triggers the throttle every millisecond for the specified duration.
+ */
+static void trigger_for(struct throttle *throttle, u32_ms_t duration)
+{
+    for (u32_ms_t i = 0; i < duration; i++) {
+        throttle_trigger(throttle);
+        work_run_for(1);
+    }
+}
+
+TEST_GROUP(throttle) {
+    struct work target = WORK_INITIALIZER(0, target_handler);
+    struct throttle leading = THROTTLE_INITIALIZER(&target, 10, THROTTLE_LEADING);
+    struct throttle trailing = THROTTLE_INITIALIZER(&target, 10, THROTTLE_TRAILING);
+    struct throttle both = THROTTLE_INITIALIZER(&target, 10, THROTTLE_LEADING | THROTTLE_TRAILING);
+
+    void setup() override
+    {
+        s_executions.clear();
+    }
+
+    void teardown() override
+    {
+        throttle_cancel(&leading);
+        throttle_cancel(&trailing);
+        throttle_cancel(&both);
+        work_cancel(&target);
+    }
+};
+
+TEST(throttle, leading)
+{
+    u64_ms_t test_start = system_uptime_get_ms();
+
+    trigger_for(&leading, 25);
+    work_run_for(20);
+
+    std::vector<u64_ms_t> expected = { test_start, test_start + 10, test_start + 20 };
+    CHECK_TRUE(expected == s_executions);
+    CHECK_EQUAL(22, leading.suppressed);
+}
+
+TEST(throttle, trailing)
+{
+    u64_ms_t test_start = system_uptime_get_ms();
+
+    trigger_for(&trailing, 25);
+    work_run_for(20);
+
+    std::vector<u64_ms_t> expected = { test_start + 10, test_start + 20, test_start + 30 };
+    CHECK_TRUE(expected == s_executions);
+    CHECK_EQUAL(22, trailing.suppressed);
+}
+
+TEST(throttle, leading_and_trailing)
+{
+    u64_ms_t test_start = system_uptime_get_ms();
+
+    trigger_for(&both, 5);
+    work_run_for(20);
+
+    std::vector<u64_ms_t> expected = { test_start, test_start + 10 };
+    CHECK_TRUE(expected == s_executions);
+    CHECK_EQUAL(3, both.suppressed);
+}
+
+TEST(throttle, single_event)
+{
+    throttle_trigger(&both);
+    work_run_for(30);
+
+    CHECK_EQUAL(1, s_executions.size());
+    CHECK_EQUAL(0, both.suppressed);
+
+    // next event after the period is passed through immediately
+    u64_ms_t now = system_uptime_get_ms();
+    throttle_trigger(&both);
+    work_run_for(0);
+
+    CHECK_EQUAL(2, s_executions.size());
+    CHECK_EQUAL(now, s_executions.back());
+}
@@ -2,6 +2,7 @@
 #include <service/work.h>
 #include <util/container_of.h>
 #include <functional>
+#include <memory>
 #include <vector>
 #include <service/system.h>
 
@@ -22,10 +23,32 @@ SimpleString StringFrom(const std::vector<class fake_work *> &order)
 
 class fake_work {
 public:
-    explicit fake_work(int32_t priority, std::function<void()> callback = std::function<void()>()) :
-        m_work(WORK_INITIALIZER(priority, fake_work_handler)),
-        m_callback(std::move(callback))
+    explicit fake_work(work_priority_t priority, std::function<void()> callback = std::function<void()>()) :
+        fake_work(WORK_INITIALIZER(priority, fake_work_handler), std::move(callback))
+    {
+    }
+
+    static fake_work idle(work_priority_t priority, std::function<void()> callback = std::function<void()>())
+    {
+        return fake_work(WORK_IDLE_INITIALIZER(priority, fake_work_handler), std::move(callback));
+    }
+
+    static fake_work isr(std::function<void()> callback = std::function<void()>())
+    {
+        return fake_work(WORK_ISR_INITIALIZER(fake_work_handler), std::move(callback));
+    }
+
+    static fake_work batch(work_priority_t priority, std::function<void()> callback = std::function<void()>())
+    {
+        return fake_work(WORK_BATCH_INITIALIZER(priority, fake_work_batch_handler), std::move(callback));
+    }
+
+    fake_work(const fake_work &) = delete;
+
+    ~fake_work()
     {
+        // items must not remain queued after the test which owns them has finished
+        work_cancel(&m_work);
     }
 
     work *get()
@@ -41,6 +64,12 @@ public:
     static void reset()
     {
         s_execution_order.clear();
+        s_batch_sizes.clear();
+    }
+
+    static const std::vector<size_t> &batch_sizes()
+    {
+        return s_batch_sizes;
     }
 
     static void check(auto &... items)
@@ -50,6 +79,13 @@ public:
     }
 
 private:
+    fake_work(work work, std::function<void()> callback) :
+        m_work(work),
+        m_last_execution(0),
+        m_callback(std::move(callback))
+    {
+    }
+
     work m_work;
     u64_ms_t m_last_execution;
     std::function<void()> m_callback;
@@ -65,10 +101,36 @@ private:
         }
     }
 
+    static void fake_work_batch_handler(work **works, size_t count)
+    {
+        s_batch_sizes.push_back(count);
+
+        for (size_t i = 0; i < count; i++) {
+            fake_work_handler(works[i]);
+        }
+    }
+
     static std::vector<fake_work *> s_execution_order;
+    static std::vector<size_t> s_batch_sizes;
 };
 
 std::vector<fake_work *> fake_work::s_execution_order;
+std::vector<size_t> fake_work::s_batch_sizes;
+
+/**
+ * Advances the uptime to shortly before the ticks wrap around in 32 bit.
+ *
+ * @return Uptime in milliseconds after advancing.
+ */
+static u64_ms_t advance_to_wraparound(u32_ms_t remaining)
+{
+    u64_tick_t target = UINT32_MAX + 1ULL - SYSTEM_MS_TO_TICKS(remaining);
+    u64_tick_t current = system_uptime_get_ticks();
+    system_busy_sleep_us(SYSTEM_TICKS_TO_US((target - current) & UINT32_MAX));
+
+    CHECK_EQUAL(target, system_uptime_get_ticks() & UINT32_MAX);
+    return system_uptime_get_ms();
+}
 
 TEST_GROUP(work) {
     void setup() override { fake_work::reset(); }
@@ -254,3 +316,423 @@ TEST(work, schedule_while_scheduled)
     fake_work::check(work);  // executed only once
     CHECK_EQUAL(test_start + 500, work.last_execution());  // first schedule wins, even if second is sooner
 }
+
+TEST(work, tick_conversion)
+{
+    CHECK_EQUAL(SYSTEM_TICK_HZ, SYSTEM_MS_TO_TICKS(1000));
+    CHECK_EQUAL(SYSTEM_TICK_HZ, SYSTEM_US_TO_TICKS(1000000));
+    CHECK_EQUAL(1000U, SYSTEM_TICKS_TO_MS(SYSTEM_TICK_HZ));
+    CHECK_EQUAL(1000000U, SYSTEM_TICKS_TO_US(SYSTEM_TICK_HZ));
+
+    // large values must not overflow
+    u64_ms_t years = 20ULL * 1000 * 60 * 60 * 24 * 365;
+    CHECK_EQUAL(years, SYSTEM_TICKS_TO_MS(SYSTEM_MS_TO_TICKS(years)));
+    CHECK_EQUAL(years * 1000, SYSTEM_TICKS_TO_US(SYSTEM_US_TO_TICKS(years * 1000)));
+}
+
+TEST(work, deadline_before)
+{
+    CHECK_TRUE(work_deadline_before(1, 2));
+    CHECK_FALSE(work_deadline_before(2, 1));
+    CHECK_FALSE(work_deadline_before(2, 2));
+
+#ifdef WORK_COMPACT_LAYOUT
+    // deadlines are compared relative to each other
+    CHECK_TRUE(work_deadline_before(UINT32_MAX, 0));
+    CHECK_FALSE(work_deadline_before(0, UINT32_MAX));
+    CHECK_TRUE(work_deadline_before(UINT32_MAX - 10, 10));
+    CHECK_TRUE(work_deadline_before(0x80000000U, 0xFFFFFFFFU));
+    CHECK_FALSE(work_deadline_before(0x7FFFFFFFU, 0));
+    CHECK_TRUE(work_deadline_before(0, 0x7FFFFFFFU));
+#endif
+}
+
+TEST(work, schedule_across_wraparound)
+{
+    auto test_start = advance_to_wraparound(100);
+
+    fake_work work1(0);
+    fake_work work2(0);
+    fake_work work3(0);
+
+    work_schedule_after(work3.get(), 300);
+    work_schedule_after(work2.get(), 150);
+    work_schedule_after(work1.get(), 50);
+
+    work_run_for(500);
+    fake_work::check(work1, work2, work3);
+
+    CHECK_EQUAL(test_start + 50, work1.last_execution());
+    CHECK_EQUAL(test_start + 150, work2.last_execution());
+    CHECK_EQUAL(test_start + 300, work3.last_execution());
+}
+
+TEST(work, schedule_again_across_wraparound)
+{
+    auto test_start = advance_to_wraparound(150);
+
+    fake_work work(0, [&] {
+        work_schedule_again(work.get(), 100);
+    });
+
+    work_schedule_after(work.get(), 100);
+    work_run_for(350);
+    fake_work::check(work, work, work);
+
+    CHECK_EQUAL(test_start + 300, work.last_execution());
+}
+
+TEST(work, idle_after_submitted)
+{
+    fake_work idle1 = fake_work::idle(2);
+    fake_work idle2 = fake_work::idle(1);
+    fake_work work1(WORK_PRIORITY_LOWEST);
+    fake_work work2(5);
+
+    work_submit(idle1.get());
+    work_submit(idle2.get());
+    work_submit(work1.get());
+    work_submit(work2.get());
+
+    // idle items are not processed while the stop request is submitted
+    work_run_for(0);
+    fake_work::check(work2, work1);
+
+    work_run_for(1);
+    fake_work::check(work2, work1, idle2, idle1);
+}
+
+TEST(work, idle_before_sleep)
+{
+    fake_work idle = fake_work::idle(0);
+    fake_work work1(0);
+
+    u64_ms_t test_start = system_uptime_get_ms();
+
+    work_schedule_after(work1.get(), 10);
+    work_submit(idle.get());
+
+    work_run_for(20);
+    fake_work::check(idle, work1);
+    CHECK_EQUAL(test_start, idle.last_execution());
+    CHECK_EQUAL(test_start + 10, work1.last_execution());
+}
+
+TEST(work, idle_preempted_by_submitted)
+{
+    fake_work work1(0);
+    bool_t first = true;
+
+    fake_work idle = fake_work::idle(0, [&]() {
+        if (first) {
+            CHECK_FALSE(work_idle_should_yield());
+
+            work_submit(work1.get());
+            CHECK_TRUE(work_idle_should_yield());
+
+            work_submit(idle.get());
+            first = false;
+        }
+    });
+
+    work_submit(idle.get());
+
+    work_run_for(1);
+    fake_work::check(idle, work1, idle);
+}
+
+TEST(work, idle_time_slice)
+{
+    u32_us_t busy_time = 0;
+
+    fake_work idle = fake_work::idle(0, [&]() {
+        while (!work_idle_should_yield()) {
+            system_busy_sleep_us(10);
+            busy_time += 10;
+        }
+    });
+
+    work_submit(idle.get());
+
+    work_run_for(10 * WORK_IDLE_TIME_SLICE_US / 1000);
+    fake_work::check(idle);
+    CHECK_EQUAL(WORK_IDLE_TIME_SLICE_US, busy_time);
+}
+
+TEST(work, idle_time_slice_ends_at_deadline)
+{
+    fake_work work1(0);
+    u64_ms_t idle_end = 0;
+
+    fake_work idle = fake_work::idle(0, [&]() {
+        while (!work_idle_should_yield()) {
+            system_busy_sleep_us(10);
+        }
+
+        idle_end = system_uptime_get_ms();
+        work_submit(idle.get());
+    });
+
+    u64_ms_t test_start = system_uptime_get_ms();
+
+    // slices end early once the scheduled item becomes ready
+    work_schedule_after(work1.get(), 3 * WORK_IDLE_TIME_SLICE_US / 1000 + 1);
+    work_submit(idle.get());
+
+    work_run_for(3 * WORK_IDLE_TIME_SLICE_US / 1000 + 1);
+    work_cancel(idle.get());
+
+    CHECK_EQUAL(test_start + 3 * WORK_IDLE_TIME_SLICE_US / 1000 + 1, work1.last_execution());
+    CHECK_EQUAL(work1.last_execution(), idle_end);
+}
+
+TEST(work, idle_waits_for_deadline)
+{
+    fake_work idle = fake_work::idle(0);
+    fake_work work1(0);
+    fake_work work2(0, []() {
+        // return shortly before work1 becomes ready
+        system_busy_sleep_us(1000 - WORK_IDLE_MIN_SLICE_US / 2);
+    });
+
+    u64_ms_t test_start = system_uptime_get_ms();
+
+    work_schedule_after(work1.get(), 1);
+    work_submit(work2.get());
+    work_submit(idle.get());
+
+    // the idle item is not started before the imminent scheduled item
+    work_run_for(2);
+    fake_work::check(work2, work1, idle);
+    CHECK_EQUAL(test_start + 1, work1.last_execution());
+}
+
+TEST(work, cancel_idle)
+{
+    fake_work idle = fake_work::idle(0);
+
+    work_submit(idle.get());
+    work_cancel(idle.get());
+
+    work_run_for(1);
+    fake_work::check();
+}
+
+TEST(work, isr_timer_during_sleep)
+{
+    fake_work timer = fake_work::isr();
+
+    u64_ms_t test_start = system_uptime_get_ms();
+
+    work_schedule_after(timer.get(), 5);
+    work_run_for(10);
+
+    fake_work::check(timer);
+    CHECK_EQUAL(test_start + 5, timer.last_execution());
+}
+
+TEST(work, isr_timer_preempts_running_work)
+{
+    fake_work timer = fake_work::isr();
+    fake_work work1(0, [&]() {
+        work_schedule_after(timer.get(), 3);
+        system_busy_sleep_ms(10);
+    });
+
+    u64_ms_t test_start = system_uptime_get_ms();
+
+    work_submit(work1.get());
+    work_run_for(0);
+
+    fake_work::check(work1, timer);
+    CHECK_EQUAL(test_start + 3, timer.last_execution());
+}
+
+TEST(work, isr_timer_before_submitted_work)
+{
+    fake_work work1(0);
+    fake_work timer = fake_work::isr();
+
+    u64_ms_t test_start = system_uptime_get_ms();
+
+    // same deadline, but the timer does not wait in the submitted queue
+    work_schedule_after(work1.get(), 5);
+    work_schedule_after(timer.get(), 5);
+    work_run_for(10);
+
+    fake_work::check(timer, work1);
+    CHECK_EQUAL(test_start + 5, timer.last_execution());
+    CHECK_EQUAL(test_start + 5, work1.last_execution());
+}
+
+TEST(work, isr_timer_periodic)
+{
+    int count = 0;
+    fake_work timer = fake_work::isr([&]() {
+        if (++count < 3) {
+            work_schedule_again(timer.get(), 4);
+        }
+    });
+
+    u64_ms_t test_start = system_uptime_get_ms();
+
+    work_schedule_after(timer.get(), 4);
+    work_run_for(20);
+
+    fake_work::check(timer, timer, timer);
+    CHECK_EQUAL(test_start + 12, timer.last_execution());
+}
+
+TEST(work, isr_timer_cancels_ready_work)
+{
+    fake_work work1(0);
+    fake_work timer2 = fake_work::isr();
+    fake_work timer1 = fake_work::isr([&]() {
+        work_cancel(work1.get());
+    });
+
+    // the timer handler removes the regular item in front of the second timer
+    work_schedule_after(work1.get(), 5);
+    work_schedule_after(timer1.get(), 6);
+    work_schedule_after(timer2.get(), 6);
+
+    system_busy_sleep_ms(10);
+    work_run_for(0);
+
+    fake_work::check(timer1, timer2);
+}
+
+TEST(work, cancel_isr_timer)
+{
+    fake_work timer = fake_work::isr();
+
+    work_schedule_after(timer.get(), 5);
+    work_cancel(timer.get());
+
+    work_run_for(10);
+    fake_work::check();
+}
+
+TEST(work, batch)
+{
+    fake_work batch1 = fake_work::batch(5);
+    fake_work batch2 = fake_work::batch(5);
+    fake_work batch3 = fake_work::batch(5);
+    fake_work work(5);
+
+    work_submit(batch1.get());
+    work_submit(batch2.get());
+    work_submit(work.get());
+    work_submit(batch3.get());
+    work_run_for(0);
+
+    // only consecutive items form a batch
+    fake_work::check(batch1, batch2, work, batch3);
+    CHECK_TRUE((std::vector<size_t>{ 2, 1 }) == fake_work::batch_sizes());
+}
+
+TEST(work, batch_priorities)
+{
+    fake_work batch1 = fake_work::batch(5);
+    fake_work batch2 = fake_work::batch(6);
+    fake_work batch3 = fake_work::batch(5);
+
+    work_submit(batch1.get());
+    work_submit(batch2.get());
+    work_submit(batch3.get());
+    work_run_for(0);
+
+    fake_work::check(batch1, batch3, batch2);
+    CHECK_TRUE((std::vector<size_t>{ 2, 1 }) == fake_work::batch_sizes());
+}
+
+TEST(work, batch_limit)
+{
+    std::vector<std::unique_ptr<fake_work>> items;
+
+    for (size_t i = 0; i < WORK_BATCH_MAX + 1; i++) {
+        items.emplace_back(new fake_work(fake_work::batch(5)));
+        work_submit(items.back()->get());
+    }
+
+    work_run_for(0);
+    CHECK_TRUE((std::vector<size_t>{ WORK_BATCH_MAX, 1 }) == fake_work::batch_sizes());
+}
+
+TEST(work, batch_resubmit)
+{
+    int remaining = 2;
+    fake_work batch1 = fake_work::batch(5, [&]() {
+        if (--remaining > 0) {
+            work_submit(batch1.get());
+        }
+    });
+    fake_work batch2 = fake_work::batch(5);
+
+    work_submit(batch1.get());
+    work_submit(batch2.get());
+    work_run_for(0);
+
+    fake_work::check(batch1, batch2, batch1);
+    CHECK_TRUE((std::vector<size_t>{ 2, 1 }) == fake_work::batch_sizes());
+}
+
+TEST(work, run_once)
+{
+    fake_work work1(5);
+    fake_work work2(6);
+    fake_work idle = fake_work::idle(0);
+
+    CHECK_FALSE(work_run_once());
+
+    work_submit(work2.get());
+    work_submit(work1.get());
+    work_submit(idle.get());
+
+    CHECK_TRUE(work_run_once());
+    fake_work::check(work1);
+
+    CHECK_TRUE(work_run_once());
+    CHECK_TRUE(work_run_once());
+    fake_work::check(work1, work2, idle);
+
+    CHECK_FALSE(work_run_once());
+}
+
+TEST(work, poll)
+{
+    fake_work work1(5);
+    fake_work work2(5, [&]() { work_submit(work1.get()); });
+    fake_work scheduled(5);
+
+    CHECK_EQUAL(WORK_POLL_INFINITE, work_poll());
+
+    // items submitted while polling are executed as well
+    work_submit(work2.get());
+    work_schedule_after(scheduled.get(), 10);
+    CHECK_EQUAL(10000, work_poll());
+    fake_work::check(work2, work1);
+
+    system_busy_sleep_ms(4);
+    CHECK_EQUAL(6000, work_poll());
+
+    system_busy_sleep_ms(6);
+    CHECK_EQUAL(WORK_POLL_INFINITE, work_poll());
+    fake_work::check(work2, work1, scheduled);
+}
+
+TEST(work, poll_idle)
+{
+    int remaining = 2;
+    fake_work idle = fake_work::idle(0, [&]() {
+        if (--remaining > 0) {
+            work_submit(idle.get());
+        }
+    });
+
+    // idle items get one time slice per call
+    work_submit(idle.get());
+    CHECK_EQUAL(0, work_poll());
+    CHECK_EQUAL(WORK_POLL_INFINITE, work_poll());
+    fake_work::check(idle, idle);
+}
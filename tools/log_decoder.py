@@ -0,0 +1,321 @@
+#!/usr/bin/env python3
+"""
+Decodes binary log output (see `log_set_binary()`) into the same text the target prints in text mode.
+
+Log frames only contain pointers to the module, the format string and string arguments. They are resolved
+using the ELF file of the running firmware, so the ELF file must match the firmware exactly.
+
+Usage:
+    stty -F /dev/ttyACM0 115200 raw
+    tools/log_decoder.py build/firmware/src/firmware/firmware.elf /dev/ttyACM0
+"""
+
+import argparse
+import struct
+import sys
+
+FRAME_SYNC = 0xA5
+FRAME_MESSAGE = 0
+FRAME_DROPPED = 1
+FRAME_HEXDUMP = 2
+
+HEXDUMP_ROW_LENGTH = 16
+
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+ANSI_BOLD_RED = '\x1b[1;31m'
+ANSI_BOLD_YELLOW = '\x1b[1;33m'
+ANSI_RESET = '\x1b[0m'
+
+LEVELS = {
+    0: ('err', ANSI_BOLD_RED),
+    1: ('wrn', ANSI_BOLD_YELLOW),
+    2: ('inf', ''),
+    3: ('dbg', ''),
+}
+
+LANES = {
+    0: 'errors and warnings',
+    1: 'messages',
+}
+
+
+class Elf:
+    """Minimal ELF reader giving access to the initialized memory of the image."""
+
+    def __init__(self, path):
+        with open(path, 'rb') as file:
+            self.data = file.read()
+
+        if self.data[:4] != b'\x7fELF':
+            raise ValueError(f'{path} is not an ELF file')
+
+        self.pointer_size = 4 if self.data[4] == 1 else 8
+        self.endian = '<' if self.data[5] == 1 else '>'
+
+        if self.pointer_size == 4:
+            shoff, = struct.unpack_from(self.endian + 'I', self.data, 0x20)
+            shentsize, shnum = struct.unpack_from(self.endian + 'HH', self.data, 0x2E)
+            section_format = 'IIIIIIIIII'
+        else:
+            shoff, = struct.unpack_from(self.endian + 'Q', self.data, 0x28)
+            shentsize, shnum = struct.unpack_from(self.endian + 'HH', self.data, 0x3A)
+            section_format = 'IIQQQQIIQQ'
+
+        self.sections = []
+
+        for i in range(shnum):
+            fields = struct.unpack_from(self.endian + section_format, self.data, shoff + i * shentsize)
+            sh_type, sh_flags, sh_addr, sh_offset, sh_size = fields[1:6]
+
+            if (sh_flags & SHF_ALLOC) and sh_type != SHT_NOBITS and sh_addr != 0:
+                self.sections.append((sh_addr, sh_offset, sh_size))
+
+    def read(self, address, length):
+        for addr, offset, size in self.sections:
+            if addr <= address and address + length <= addr + size:
+                start = offset + address - addr
+                return self.data[start:start + length]
+
+        return None
+
+    def read_pointer(self, address):
+        data = self.read(address, self.pointer_size)
+
+        if data is None:
+            return None
+
+        return int.from_bytes(data, 'little' if self.endian == '<' else 'big')
+
+    def read_string(self, address):
+        for addr, offset, size in self.sections:
+            if addr <= address < addr + size:
+                start = offset + address - addr
+                end = self.data.find(b'\0', start, offset + size)
+
+                if end < 0:
+                    return None
+
+                return self.data[start:end].decode('utf-8', errors='replace')
+
+        return None
+
+
+class Package:
+    """Reader for the arguments captured by `cbprintf_capture()`."""
+
+    def __init__(self, elf, data):
+        self.elf = elf
+        self.data = data
+        self.index = 0
+
+    def read(self, size, signed=False):
+        if self.index + size > len(self.data):
+            raise ValueError('truncated package')
+
+        value = int.from_bytes(self.data[self.index:self.index + size],
+                               'little' if self.elf.endian == '<' else 'big', signed=signed)
+        self.index += size
+        return value
+
+
+def format_package(elf, package):
+    """Formats a captured format string like `cbprintf_restore()`."""
+    format_address = package.read(elf.pointer_size)
+    fmt = elf.read_string(format_address)
+
+    if fmt is None:
+        return f'<unknown format string 0x{format_address:x}>'
+
+    # arguments are stored promoted (char and short as int), long has the size of a pointer on all supported
+    # targets (ILP32 and LP64)
+    sizes = {'': 4, 'hh': 4, 'h': 4, 'l': elf.pointer_size, 'll': 8, 'z': elf.pointer_size}
+    truncated = {'hh': 8, 'h': 16}
+
+    result = []
+    i = 0
+
+    while i < len(fmt):
+        if fmt[i] != '%':
+            result.append(fmt[i])
+            i += 1
+            continue
+
+        # parse flags, width and length
+        i += 1
+        zeroes = False
+        width = 0
+
+        while i < len(fmt) and fmt[i].isdigit():
+            if fmt[i] == '0' and width == 0:
+                zeroes = True
+            else:
+                width = width * 10 + int(fmt[i])
+            i += 1
+
+        length = ''
+
+        while i < len(fmt) and fmt[i] in 'hlz':
+            length += fmt[i]
+            i += 1
+
+        if i >= len(fmt) or length not in sizes:
+            break
+
+        specifier = fmt[i]
+        i += 1
+        pad = '0' if zeroes else ''
+
+        if specifier in 'di':
+            value = package.read(sizes[length], signed=True)
+
+            if length in truncated:
+                bits = truncated[length]
+                value = (value + (1 << (bits - 1))) % (1 << bits) - (1 << (bits - 1))
+
+            result.append(f'{value:{pad}{width}d}')
+        elif specifier in 'ux':
+            value = package.read(sizes[length])
+
+            if length in truncated:
+                value %= 1 << truncated[length]
+
+            result.append(f'{value:{pad}{width}{"d" if specifier == "u" else "x"}}')
+        elif specifier == 'p':
+            value = package.read(elf.pointer_size)
+            result.append(f'0x{value:{pad}{width}x}' if value != 0 else '(nil)')
+        elif specifier == 's':
+            address = package.read(elf.pointer_size)
+            string = elf.read_string(address)
+            result.append(string if string is not None else f'<string 0x{address:x}>')
+        elif specifier == '%':
+            result.append('%')
+        else:
+            break
+
+    return ''.join(result)
+
+
+def format_prefix(elf, payload):
+    """Formats the header of a message frame like the target, returns the prefix and the header size."""
+    header_format = elf.endian + ('I' if elf.pointer_size == 4 else 'Q') + 'QB'
+    header_size = struct.calcsize(header_format)
+    module_address, timestamp, level = struct.unpack_from(header_format, payload, 0)
+
+    name_address = elf.read_pointer(module_address)
+    name = elf.read_string(name_address) if name_address is not None else None
+
+    if name is None:
+        name = f'<module 0x{module_address:x}>'
+
+    level_str, color = LEVELS.get(level, ('', ''))
+
+    timestamp_s = (timestamp // 1000000) & 0xFFFFFFFF
+    timestamp_us = timestamp % 1000000
+
+    prefix = (f'[{timestamp_s // 3600:02d}:{timestamp_s // 60 % 60:02d}:{timestamp_s % 60:02d}.'
+              f'{timestamp_us // 1000:03d},{timestamp_us % 1000:03d}] {color}<{level_str}> {name}: ')
+
+    return prefix, header_size
+
+
+def format_message(elf, payload):
+    """Formats a message frame like the text output of the target."""
+    prefix, header_size = format_prefix(elf, payload)
+
+    try:
+        text = format_package(elf, Package(elf, payload[header_size:]))
+    except ValueError as error:
+        text = f'<{error}>'
+
+    return prefix + text + ANSI_RESET
+
+
+def format_hexdump(elf, payload):
+    """Formats a hexdump frame like the text output of the target."""
+    prefix, header_size = format_prefix(elf, payload)
+    description_address = int.from_bytes(payload[header_size:header_size + elf.pointer_size],
+                                          'little' if elf.endian == '<' else 'big')
+    description = elf.read_string(description_address)
+
+    if description is None:
+        description = f'<string 0x{description_address:x}>'
+
+    lines = [prefix + description + ANSI_RESET]
+    data = payload[header_size + elf.pointer_size:]
+
+    for offset in range(0, len(data), HEXDUMP_ROW_LENGTH):
+        row = data[offset:offset + HEXDUMP_ROW_LENGTH]
+        hex_values = ''.join(f'{byte:02x} ' for byte in row).ljust(3 * HEXDUMP_ROW_LENGTH)
+        characters = ''.join(chr(byte) if 0x20 <= byte <= 0x7E else '.' for byte in row)
+        lines.append(f'    {offset:04x}: {hex_values} |{characters}|')
+
+    return '\n'.join(lines)
+
+
+def read_frames(stream):
+    """Yields (type, payload) of all valid frames, resynchronizing on the sync byte after errors."""
+    buffer = bytearray()
+
+    while True:
+        chunk = stream.read1(256) if hasattr(stream, 'read1') else stream.read(256)
+
+        if not chunk:
+            return
+
+        buffer += chunk
+
+        while len(buffer) >= 3:
+            if buffer[0] != FRAME_SYNC:
+                del buffer[0]
+                continue
+
+            frame_length = 3 + buffer[2] + 1
+
+            if len(buffer) < frame_length:
+                break
+
+            checksum = 0
+
+            for byte in buffer[1:frame_length]:
+                checksum ^= byte
+
+            if checksum != 0:
+                del buffer[0]
+                continue
+
+            yield buffer[1], bytes(buffer[3:frame_length - 1])
+            del buffer[:frame_length]
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decodes binary log output using the firmware ELF file.')
+    parser.add_argument('elf', help='ELF file of the running firmware')
+    parser.add_argument('input', nargs='?', help='file or serial device to read from (default: stdin)')
+    parser.add_argument('--no-color', action='store_true', help='strip ANSI colors')
+    args = parser.parse_args()
+
+    elf = Elf(args.elf)
+    stream = open(args.input, 'rb', buffering=0) if args.input else sys.stdin.buffer
+
+    for frame_type, payload in read_frames(stream):
+        if frame_type == FRAME_MESSAGE:
+            line = format_message(elf, payload)
+        elif frame_type == FRAME_HEXDUMP:
+            line = format_hexdump(elf, payload)
+        elif frame_type == FRAME_DROPPED and len(payload) == 5:
+            count, lane = struct.unpack(elf.endian + 'IB', payload)
+            line = f'{ANSI_BOLD_RED}--- {count} {LANES.get(lane, "messages")} dropped ---{ANSI_RESET}'
+        else:
+            continue
+
+        if args.no_color:
+            for code in (ANSI_BOLD_RED, ANSI_BOLD_YELLOW, ANSI_RESET):
+                line = line.replace(code, '')
+
+        print(line, flush=True)
+
+
+if __name__ == '__main__':
+    main()